@@ -57,146 +57,45 @@ char *color_name[] = { "BLUE", "GREEN", "RED", "WHITE" ,"CYAN","MAGENTA","YELLOW
 uint16_t color_mask[] = { 0x001F, 0x07E0, 0xF800, 0xFFFF,0x07FF,0xF81F,0xFFE0 };
 
     
+//each character is drawn as one glyph, in a single address window (or a run
+//of set pixels at a time in overlay mode)
 void show_16font(uint16_t x, uint16_t y,uint16_t fc, uint16_t bc,uint8_t *str,uint8_t mode)
 {
-    uint16_t i,j,k,c_num,color=0;
-    boolean first = true;
+    uint16_t k,c_num;
     c_num = sizeof(tfont16)/sizeof(typFNT_GB16);
     for(k=0;k<c_num;k++)
     {         //pgm_read_byte
          if((pgm_read_byte(&tfont16[k].Index[0])==*str) && (pgm_read_byte(&tfont16[k].Index[1])==*(str+1)))
          {
-            my_lcd.Set_Addr_Window(x, y, x+16-1, y+16-1); 
-            for(j=0;j<32;j++)
-            {
-               for(i = 0;i<8;i++)  
-               {
-                  if(mode) //叠加模式
-                  {
-                    if(pgm_read_byte(&tfont16[k].Msk[j])&(0x80>>i))
-                    {
-                        my_lcd.Set_Draw_color(fc);
-                        my_lcd.Draw_Pixel(x+((j*8+i)%16),y+((j*8+i)/16));
-                     }
-                    // x++;
-                    // if((x-x0)==16)
-                    // {
-                   //     x = x0;
-                   //     y++;   
-                   //  }
-     
-                  }
-                  else   //非叠加模式
-                  {
-                    if(pgm_read_byte(&tfont16[k].Msk[j])&(0x80>>i))
-                    {
-                         color = fc;
-                     }
-                     else
-                     {
-                        color = bc;
-                     }
-                     my_lcd.Push_Any_Color(&color, 1, first, 0);
-                    first = false;
-                  }
-               }
-            } 
-      }
+            my_lcd.Draw_Glyph(x, y, (const uint8_t *)tfont16[k].Msk, 16, 16, fc, bc, mode ? 3 : 1);
+         }
     } 
           
 }
 
 void show_24font(uint16_t x, uint16_t y,uint16_t fc, uint16_t bc,uint8_t *str,uint8_t mode)
 {
-    uint16_t i,j,k,c_num,color;
-    boolean first = true;
+    uint16_t k,c_num;
     c_num = sizeof(tfont24)/sizeof(typFNT_GB24);
     for(k=0;k<c_num;k++)
     {
          if((pgm_read_byte(&tfont24[k].Index[0])==*str) && (pgm_read_byte(&tfont24[k].Index[1])==*(str+1)))
          {
-            my_lcd.Set_Addr_Window(x, y, x+24-1, y+24-1); 
-            for(j=0;j<72;j++)
-            {
-               for(i = 0;i<8;i++)  
-               {
-                  if(mode) //叠加模式
-                  {
-                    if(pgm_read_byte(&tfont24[k].Msk[j])&(0x80>>i))
-                    {
-                        my_lcd.Set_Draw_color(fc);
-                        my_lcd.Draw_Pixel(x+((j*8+i)%24),y+((j*8+i)/24));
-                     }
-                  //   x++;
-                  //   if((x-x0)==32)
-                  //   {
-                  //      x = x0;
-                  //      y++;   
-                  //   }
-                  }
-                  else   //非叠加模式
-                  {
-                    if(pgm_read_byte(&tfont24[k].Msk[j])&(0x80>>i))
-                    {
-                         color = fc;
-                     }
-                     else
-                     {
-                        color = bc;
-                     }
-                     my_lcd.Push_Any_Color(&color, 1, first, 0);
-                     first = false;
-                  }
-               }
-            } 
-      }
+            my_lcd.Draw_Glyph(x, y, (const uint8_t *)tfont24[k].Msk, 24, 24, fc, bc, mode ? 3 : 1);
+         }
     }
 }
 
 void show_32font(uint16_t x, uint16_t y,uint16_t fc, uint16_t bc,uint8_t *str,uint8_t mode)
 {
-    uint16_t i,j,k,c_num,color;
-    boolean first = true;
+    uint16_t k,c_num;
     c_num = sizeof(tfont32)/sizeof(typFNT_GB32);
     for(k=0;k<c_num;k++)
     {
          if((pgm_read_byte(&tfont32[k].Index[0])==*str) && (pgm_read_byte(&tfont32[k].Index[1])==*(str+1)))
          {
-            my_lcd.Set_Addr_Window(x, y, x+32-1, y+32-1); 
-            for(j=0;j<128;j++)
-            {
-               for(i = 0;i<8;i++)  
-               {
-                  if(mode) //叠加模式
-                  {
-                    if(pgm_read_byte(&tfont32[k].Msk[j])&(0x80>>i))
-                    {
-                        my_lcd.Set_Draw_color(fc);
-                        my_lcd.Draw_Pixel(x+((j*8+i)%32),y+((j*8+i)/32));
-                     }
-                   //  x++;
-                  //   if((x-x0)==32)
-                   //  {
-                  //      x = x0;
-                  //      y++;   
-                   //  }
-                  }
-                  else   //非叠加模式
-                  {
-                    if(pgm_read_byte(&tfont32[k].Msk[j])&(0x80>>i))
-                    {
-                         color = fc;
-                     }
-                     else
-                     {
-                        color = bc;
-                     }
-                    my_lcd.Push_Any_Color(&color, 1, first, 0);
-                    first = false;
-                  }
-               }
-            } 
-      }
+            my_lcd.Draw_Glyph(x, y, (const uint8_t *)tfont32[k].Msk, 32, 32, fc, bc, mode ? 3 : 1);
+         }
     }
 }
 
@@ -0,0 +1,1022 @@
+// Off screen RAM canvas for the Lcdwiki GUI library
+// MIT license
+
+#include "LCDWIKI_Canvas.h"
+#include "lcd_spi_image.h"
+
+/*!
+ * @brief Create a canvas on a buffer supplied by the sketch
+ *
+ * @param wid The width of the canvas in pixels
+ * @param heg The height of the canvas in pixels
+ * @param buffer The wid * heg colours of the canvas, row by row
+ */
+LCDWIKI_Canvas::LCDWIKI_Canvas(int16_t wid, int16_t heg, uint16_t *buffer) {
+	width = wid;
+	height = heg;
+	this->buffer = buffer;
+
+	view_x = 0;
+	view_y = 0;
+	view_w = wid;
+	view_h = heg;
+
+	win_x1 = 0;
+	win_y1 = 0;
+	win_x2 = wid - 1;
+	win_y2 = heg - 1;
+	cur_x = 0;
+	cur_y = 0;
+
+	damage = NULL;
+	dmg_x1 = 0x7FFF;
+	dmg_y1 = 0x7FFF;
+	dmg_x2 = -1;
+	dmg_y2 = -1;
+
+	text_x = 0;
+	text_y = 0;
+	text_color = 0xFFFF;
+	text_bgcolor = 0;
+	draw_color = 0xFFFF;
+	text_size = 1;
+	text_mode = 0;
+}
+
+uint16_t LCDWIKI_Canvas::Color_To_565(uint8_t r, uint8_t g, uint8_t b) {
+	return ((r& 0xF8) << 8) | ((g & 0xFC) << 3) | ((b & 0xF8) >> 3);
+}
+
+void LCDWIKI_Canvas::Draw_Pixe(int16_t x, int16_t y, uint16_t color) {
+	Put(x - view_x, y - view_y, color);
+	Commit_Damage();
+}
+
+/*!
+ * @brief Fill a rectangle, cropped to the canvas.  As with the display, a
+ *   negative width or height runs left or up from x, y.
+ */
+void LCDWIKI_Canvas::Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+	int16_t end;
+
+	if (w < 0) {
+		w = -w;
+		x -= w;
+	}
+	x -= view_x;
+	end = x + w;
+	if (x < 0) {
+		x = 0;
+	}
+	if (end > width) {
+		end = width;
+	}
+	w = end - x;
+
+	if (h < 0) {
+		h = -h;
+		y -= h;
+	}
+	y -= view_y;
+	end = y + h;
+	if (y < 0) {
+		y = 0;
+	}
+	if (end > height) {
+		end = height;
+	}
+	h = end - y;
+
+	if((w <= 0) || (h <= 0)) {
+		return;
+	}
+
+	if(damage) {
+		// pixel by pixel, so that only what changes is damaged
+		for(int16_t j = 0; j < h; j++) {
+			for(int16_t i = 0; i < w; i++) {
+				Put(x + i, y + j, color);
+			}
+		}
+		Commit_Damage();
+		return;
+	}
+
+	uint16_t *row = buffer + (int32_t)y * width + x;
+	while(h--) {
+		for(int16_t i = 0; i < w; i++) {
+			row[i] = color;
+		}
+		row += width;
+	}
+}
+
+/*!
+ * @brief Set the window that Push_Any_Color() fills, left to right and then
+ *   top to bottom, the same as the display's memory write
+ */
+void LCDWIKI_Canvas::Set_Addr_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	win_x1 = x1 - view_x;
+	win_y1 = y1 - view_y;
+	win_x2 = x2 - view_x;
+	win_y2 = y2 - view_y;
+	cur_x = win_x1;
+	cur_y = win_y1;
+}
+
+/*!
+ * @brief Write colours into the window set by Set_Addr_Window(), wrapping at
+ *   the right hand edge of the window.  Pixels that fall off the canvas are
+ *   dropped.
+ *
+ * @param block The rgb565 colours
+ * @param n The number of colours
+ * @param first Start again from the top left of the window
+ * @param flags 00000001 - the block is in PROGMEM, else RAM
+ */
+void LCDWIKI_Canvas::Push_Any_Color(uint16_t *block, int16_t n, bool first, uint8_t flags) {
+	bool isconst = flags & 1;
+
+	if(first) {
+		Restart_Window();
+	}
+
+	while(n-- > 0) {
+		Write_Next(isconst ? pgm_read_word(block++) : *block++);
+	}
+	Commit_Damage();
+}
+
+/*!
+ * @brief Copy a rectangle of the canvas out to block, row by row.  Pixels
+ *   off the canvas read as 0 (black).
+ *
+ * @return 0, the same as LCDWIKI_SPI::Read_GRAM()
+ */
+int16_t LCDWIKI_Canvas::Read_GRAM(int16_t x, int16_t y, uint16_t *block, int16_t w, int16_t h) {
+	for(int16_t j = 0; j < h; j++) {
+		for(int16_t i = 0; i < w; i++) {
+			*block++ = Read_Pixel(x + i - view_x, y + j - view_y);
+		}
+	}
+
+	return 0;
+}
+
+/*!
+ * @brief Get the height of the area that the canvas stands in for, which is
+ *   the height of the canvas unless Set_View() has been called
+ */
+int16_t LCDWIKI_Canvas::Get_Height(void) const {
+	return view_h;
+}
+
+/*!
+ * @brief Get the width of the area that the canvas stands in for, which is
+ *   the width of the canvas unless Set_View() has been called
+ */
+int16_t LCDWIKI_Canvas::Get_Width(void) const {
+	return view_w;
+}
+
+/*!
+ * @brief Get the colour of one pixel of the buffer (x, y are from the top
+ *   left of the buffer, whatever the view)
+ *
+ * @return The rgb565 colour, or 0 if x, y is off the canvas
+ */
+uint16_t LCDWIKI_Canvas::Read_Pixel(int16_t x, int16_t y) const {
+	if((x < 0) || (y < 0) || (x >= width) || (y >= height)) {
+		return 0;
+	}
+
+	return buffer[(int32_t)y * width + x];
+}
+
+/*!
+ * @brief Get the buffer that the canvas draws to, width * height colours
+ *   row by row
+ */
+uint16_t *LCDWIKI_Canvas::Get_Buffer(void) const {
+	return buffer;
+}
+
+int16_t LCDWIKI_Canvas::Get_Buffer_Width(void) const {
+	return width;
+}
+
+int16_t LCDWIKI_Canvas::Get_Buffer_Height(void) const {
+	return height;
+}
+
+/*!
+ * @brief Make the canvas stand in for the part at x, y of a w by h area.
+ *   Everything drawn on the canvas is then in the co-ordinates of the area,
+ *   and only what lands on the buffer is kept.  Get_Width() and Get_Height()
+ *   give the size of the area, so Fill_Screen() and the like cover all of 
+ *   it.  Set_View(0, 0, width, height) puts the canvas back to normal.
+ *
+ * @param x The x co-ordinate in the area of the left of the buffer
+ * @param y The y co-ordinate in the area of the top of the buffer
+ * @param w The width of the area
+ * @param h The height of the area
+ */
+void LCDWIKI_Canvas::Set_View(int16_t x, int16_t y, int16_t w, int16_t h) {
+	view_x = x;
+	view_y = y;
+	view_w = w;
+	view_h = h;
+}
+
+/*!
+ * @brief Set the damage list that drawing to the canvas adds to, only pixels
+ *   whose colour changes are added.  See LCDWIKI_SPI::Begin_Frame().
+ *
+ * @param damage The damage list, or NULL to stop recording damage
+ */
+void LCDWIKI_Canvas::Set_Damage(LCDWIKI_Damage *damage) {
+	Commit_Damage();
+	this->damage = damage;
+}
+
+/*!
+ * @brief Go back to the top left of the window set by Set_Addr_Window()
+ */
+void LCDWIKI_Canvas::Restart_Window(void) {
+	cur_x = win_x1;
+	cur_y = win_y1;
+}
+
+/*!
+ * @brief Add the bounds of the pixels changed by Write_Next() since the last
+ *   call to the damage list
+ */
+void LCDWIKI_Canvas::Commit_Damage(void) {
+	if(damage && (dmg_x1 <= dmg_x2)) {
+		damage->Add(dmg_x1, dmg_y1, dmg_x2, dmg_y2);
+	}
+
+	dmg_x1 = 0x7FFF;
+	dmg_y1 = 0x7FFF;
+	dmg_x2 = -1;
+	dmg_y2 = -1;
+}
+
+// note that column x of a page has changed, where dirty_first and dirty_last
+// hold the first and last changed column of each page
+static inline void Mark_Dirty(uint8_t *dirty_first, uint8_t *dirty_last, int16_t page, int16_t x) {
+	if(!dirty_first) {
+		return;
+	}
+
+	if(x < dirty_first[page]) {
+		dirty_first[page] = x;
+	}
+	if(x > dirty_last[page]) {
+		dirty_last[page] = x;
+	}
+}
+
+/*!
+ * @brief Create a 1 bit per pixel canvas on a buffer supplied by the sketch
+ *
+ * @param wid The width of the canvas in pixels
+ * @param heg The height of the canvas in pixels
+ * @param buffer The wid * ((heg + 7) / 8) bytes of the canvas
+ */
+LCDWIKI_Mono_Canvas::LCDWIKI_Mono_Canvas(int16_t wid, int16_t heg, uint8_t *buffer) {
+	width = wid;
+	height = heg;
+	this->buffer = buffer;
+
+	win_x1 = 0;
+	win_y1 = 0;
+	win_x2 = wid - 1;
+	win_y2 = heg - 1;
+	cur_x = 0;
+	cur_y = 0;
+
+	text_x = 0;
+	text_y = 0;
+	text_color = 0xFFFF;
+	text_bgcolor = 0;
+	draw_color = 0xFFFF;
+	text_size = 1;
+	text_mode = 0;
+}
+
+uint16_t LCDWIKI_Mono_Canvas::Color_To_565(uint8_t r, uint8_t g, uint8_t b) {
+	return ((r& 0xF8) << 8) | ((g & 0xFC) << 3) | ((b & 0xF8) >> 3);
+}
+
+void LCDWIKI_Mono_Canvas::Draw_Pixe(int16_t x, int16_t y, uint16_t color) {
+	if((x < 0) || (y < 0) || (x >= width) || (y >= height)) {
+		return;
+	}
+
+	if(color) {
+		buffer[(y/8)*width+x] |= 1 << (y%8);
+	} else {
+		buffer[(y/8)*width+x] &= ~(1 << (y%8));
+	}
+}
+
+/*!
+ * @brief Set (any colour but 0) or clear a rectangle, cropped to the canvas
+ */
+void LCDWIKI_Mono_Canvas::Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+	if(Clip(x, y, w, h)) {
+		Rect_Op(buffer, width, x, y, w, h, color ? MONO_SET : MONO_CLEAR, NULL, NULL);
+	}
+}
+
+/*!
+ * @brief Set the window that Push_Any_Color() fills, left to right and then
+ *   top to bottom, the same as the display's memory write
+ */
+void LCDWIKI_Mono_Canvas::Set_Addr_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	win_x1 = x1;
+	win_y1 = y1;
+	win_x2 = x2;
+	win_y2 = y2;
+	cur_x = x1;
+	cur_y = y1;
+}
+
+/*!
+ * @brief Write colours into the window set by Set_Addr_Window(), wrapping at
+ *   the right hand edge of the window, any colour but 0 sets the pixel.
+ *
+ * @param block The rgb565 colours
+ * @param n The number of colours
+ * @param first Start again from the top left of the window
+ * @param flags 00000001 - the block is in PROGMEM, else RAM
+ */
+void LCDWIKI_Mono_Canvas::Push_Any_Color(uint16_t *block, int16_t n, bool first, uint8_t flags) {
+	bool isconst = flags & 1;
+
+	if(first) {
+		cur_x = win_x1;
+		cur_y = win_y1;
+	}
+
+	while(n-- > 0) {
+		Draw_Pixe(cur_x, cur_y, isconst ? pgm_read_word(block++) : *block++);
+		if(++cur_x > win_x2) {
+			cur_x = win_x1;
+			if(++cur_y > win_y2) {
+				cur_y = win_y1;
+			}
+		}
+	}
+}
+
+/*!
+ * @brief Copy a rectangle of the canvas out to block, row by row, as 0xFFFF
+ *   for a set pixel and 0 for a clear one (or one off the canvas)
+ *
+ * @return 0, the same as LCDWIKI_SPI::Read_GRAM()
+ */
+int16_t LCDWIKI_Mono_Canvas::Read_GRAM(int16_t x, int16_t y, uint16_t *block, int16_t w, int16_t h) {
+	for(int16_t j = 0; j < h; j++) {
+		for(int16_t i = 0; i < w; i++) {
+			*block++ = Read_Pixel(x + i, y + j) ? 0xFFFF : 0;
+		}
+	}
+
+	return 0;
+}
+
+int16_t LCDWIKI_Mono_Canvas::Get_Height(void) const {
+	return height;
+}
+
+int16_t LCDWIKI_Mono_Canvas::Get_Width(void) const {
+	return width;
+}
+
+/*!
+ * @brief Invert a rectangle, cropped to the canvas
+ */
+void LCDWIKI_Mono_Canvas::Invert_Rect(int16_t x, int16_t y, int16_t w, int16_t h) {
+	if(Clip(x, y, w, h)) {
+		Rect_Op(buffer, width, x, y, w, h, MONO_INVERT, NULL, NULL);
+	}
+}
+
+/*!
+ * @brief Draw a bitmap in the same layout as the canvas (see 
+ *   LCDWIKI_SPI::SH1106_Draw_Bitmap()), cropped to the canvas
+ *
+ * @param x The left of the bitmap
+ * @param y The top of the bitmap
+ * @param width The width of the bitmap
+ * @param height The height of the bitmap, rounded up to a multiple of 8
+ * @param BMP The bitmap, in PROGMEM
+ * @param mode 1 to draw the bitmap as it is, 0 to draw it inverted
+ */
+void LCDWIKI_Mono_Canvas::Draw_Bitmap(int16_t x, int16_t y, uint8_t width, uint8_t height, const uint8_t *BMP, uint8_t mode) {
+	Bitmap_Op(buffer, this->width, (this->height + 7) / 8, x, y, width, height, BMP, mode, NULL, NULL);
+}
+
+/*!
+ * @brief Whether one pixel is set, false if x, y is off the canvas
+ */
+boolean LCDWIKI_Mono_Canvas::Read_Pixel(int16_t x, int16_t y) const {
+	if((x < 0) || (y < 0) || (x >= width) || (y >= height)) {
+		return false;
+	}
+
+	return (buffer[(y/8)*width+x] >> (y%8)) & 1;
+}
+
+/*!
+ * @brief Get the buffer that the canvas draws to
+ */
+uint8_t *LCDWIKI_Mono_Canvas::Get_Buffer(void) const {
+	return buffer;
+}
+
+/*!
+ * @brief Clear, set or invert a rectangle of a 1 bit per pixel buffer a byte 
+ *   (8 rows of one column) at a time, with a mask for the rows of the top 
+ *   and bottom pages that are in the rectangle and whole bytes for the 
+ *   pages between.
+ *
+ * @param buffer The buffer, in the SH1106 layout
+ * @param stride The width of the buffer, the bytes in a page
+ * @param x The left column
+ * @param y The top row
+ * @param w The width, the rectangle must be on the buffer
+ * @param h The height
+ * @param op MONO_CLEAR, MONO_SET or MONO_INVERT
+ * @param dirty_first The first changed column of each page, updated for the 
+ *   bytes that change (or NULL)
+ * @param dirty_last The last changed column of each page
+ */
+void LCDWIKI_Mono_Canvas::Rect_Op(uint8_t *buffer, int16_t stride, int16_t x, int16_t y, int16_t w, int16_t h, uint8_t op, 
+		uint8_t *dirty_first, uint8_t *dirty_last) {
+	int16_t y2 = y + h - 1;
+
+	for(int16_t page = y / 8; page <= y2 / 8; page++) {
+		uint8_t top = (page == y / 8) ? (y % 8) : 0;
+		uint8_t bottom = (page == y2 / 8) ? (y2 % 8) : 7;
+		uint8_t mask = (0xFF << top) & (0xFF >> (7 - bottom));
+
+		// each byte becomes ((byte & and_mask) | or_mask) ^ xor_mask
+		uint8_t and_mask = (op == MONO_CLEAR) ? ~mask : 0xFF;
+		uint8_t or_mask = (op == MONO_SET) ? mask : 0;
+		uint8_t xor_mask = (op == MONO_INVERT) ? mask : 0;
+
+		uint8_t *b = &buffer[page * stride + x];
+		int16_t first = -1;
+		int16_t last = 0;
+
+		for(int16_t i = 0; i < w; i++) {
+			uint8_t old = b[i];
+
+			b[i] = ((old & and_mask) | or_mask) ^ xor_mask;
+			if(b[i] != old) {
+				if(first < 0) {
+					first = i;
+				}
+				last = i;
+			}
+		}
+
+		if(first >= 0) {
+			Mark_Dirty(dirty_first, dirty_last, page, x + first);
+			Mark_Dirty(dirty_first, dirty_last, page, x + last);
+		}
+	}
+}
+
+/*!
+ * @brief Draw a bitmap in the SH1106 layout into a 1 bit per pixel buffer.
+ *   Each source byte is shifted into the one or two pages that it lands in,
+ *   whole rows of 8 at a time, so the height is rounded up to a multiple of
+ *   8.  Whatever is off the buffer is dropped.
+ *
+ * @param buffer The buffer, in the SH1106 layout
+ * @param stride The width of the buffer, the bytes in a page
+ * @param pages The number of pages in the buffer
+ * @param x The left of the bitmap
+ * @param y The top of the bitmap
+ * @param width The width of the bitmap
+ * @param height The height of the bitmap
+ * @param BMP The bitmap, in PROGMEM
+ * @param mode 1 to draw the bitmap as it is, 0 to draw it inverted
+ * @param dirty_first The first changed column of each page, updated for the 
+ *   bytes that change (or NULL)
+ * @param dirty_last The last changed column of each page
+ */
+void LCDWIKI_Mono_Canvas::Bitmap_Op(uint8_t *buffer, int16_t stride, int16_t pages, int16_t x, int16_t y, uint8_t width, uint8_t height, 
+		const uint8_t *BMP, uint8_t mode, uint8_t *dirty_first, uint8_t *dirty_last) {
+	uint8_t shift = (y >= 0) ? (y % 8) : ((8 - (-y % 8)) % 8);
+	int16_t top_page = (y - shift) / 8;
+
+	for(uint8_t i = 0; i < (height + 7) / 8; i++) {
+		for(uint8_t j = 0; j < width; j++) {
+			int16_t col = x + j;
+
+			if((col < 0) || (col >= stride)) {
+				continue;
+			}
+
+			uint8_t tmp = pgm_read_byte(&BMP[i * width + j]);
+			if(!mode) {
+				tmp = ~tmp;
+			}
+
+			// the source byte straddles this page and (unless it is aligned) the next
+			for(uint8_t half = 0; half < (shift ? 2 : 1); half++) {
+				int16_t page = top_page + i + half;
+				uint8_t bits = half ? (tmp >> (8 - shift)) : (tmp << shift);
+				uint8_t mask = half ? (0xFF >> (8 - shift)) : (0xFF << shift);
+
+				if((page < 0) || (page >= pages)) {
+					continue;
+				}
+
+				uint8_t *b = &buffer[page * stride + col];
+				uint8_t v = (*b & ~mask) | (bits & mask);
+
+				if(v != *b) {
+					*b = v;
+					Mark_Dirty(dirty_first, dirty_last, page, col);
+				}
+			}
+		}
+	}
+}
+
+// crop a rectangle to the canvas, a negative width or height runs left or up
+boolean LCDWIKI_Mono_Canvas::Clip(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const {
+	if (w < 0) {
+		w = -w;
+		x -= w;
+	}
+	if (x < 0) {
+		w += x;
+		x = 0;
+	}
+	if (x + w > width) {
+		w = width - x;
+	}
+
+	if (h < 0) {
+		h = -h;
+		y -= h;
+	}
+	if (y < 0) {
+		h += y;
+		y = 0;
+	}
+	if (y + h > height) {
+		h = height - y;
+	}
+
+	return((w > 0) && (h > 0));
+}
+
+/*!
+ * @brief Create an indexed canvas on a buffer supplied by the sketch, with 
+ *   no palette yet (everything is black until Set_Palette())
+ *
+ * @param wid The width of the canvas in pixels
+ * @param heg The height of the canvas in pixels
+ * @param bits The bits per pixel, 4 or 8
+ * @param buffer The heg * ((wid * bits + 7) / 8) bytes of the canvas
+ */
+LCDWIKI_Indexed_Canvas::LCDWIKI_Indexed_Canvas(int16_t wid, int16_t heg, uint8_t bits, uint8_t *buffer) {
+	width = wid;
+	height = heg;
+	this->bits = (bits == 8) ? 8 : 4;
+	stride = ((int32_t)wid * this->bits + 7) / 8;
+	this->buffer = buffer;
+
+	palette = NULL;
+	entries = 0;
+	palette_const = false;
+
+	index_bounds = NULL;
+	index_rows = NULL;
+
+	win_x1 = 0;
+	win_y1 = 0;
+	win_x2 = wid - 1;
+	win_y2 = heg - 1;
+	cur_x = 0;
+	cur_y = 0;
+
+	text_x = 0;
+	text_y = 0;
+	text_color = 1;
+	text_bgcolor = 0;
+	draw_color = 1;
+	text_size = 1;
+	text_mode = 0;
+}
+
+/*!
+ * @brief Find the colour in the palette nearest to r, g, b
+ *
+ * @return The palette index, to use as the colour for this canvas
+ */
+uint16_t LCDWIKI_Indexed_Canvas::Color_To_565(uint8_t r, uint8_t g, uint8_t b) {
+	uint16_t best = 0;
+	uint32_t best_distance = 0xFFFFFFFF;
+
+	for(uint16_t i = 0; i < entries; i++) {
+		uint16_t c = Get_Color(i);
+		int16_t dr = (int16_t)((c >> 8) & 0xF8) - r;
+		int16_t dg = (int16_t)((c >> 3) & 0xFC) - g;
+		int16_t db = (int16_t)((c << 3) & 0xF8) - b;
+		uint32_t distance = (int32_t)dr * dr + (int32_t)dg * dg + (int32_t)db * db;
+
+		if(distance < best_distance) {
+			best = i;
+			best_distance = distance;
+		}
+	}
+
+	return best;
+}
+
+void LCDWIKI_Indexed_Canvas::Draw_Pixe(int16_t x, int16_t y, uint16_t color) {
+	Put(x, y, color);
+}
+
+/*!
+ * @brief Fill a rectangle with a palette index, cropped to the canvas.  As 
+ *   with the display, a negative width or height runs left or up from x, y.
+ */
+void LCDWIKI_Indexed_Canvas::Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+	uint8_t index = color;
+
+	if (w < 0) {
+		w = -w;
+		x -= w;
+	}
+	if (x < 0) {
+		w += x;
+		x = 0;
+	}
+	if (x + w > width) {
+		w = width - x;
+	}
+
+	if (h < 0) {
+		h = -h;
+		y -= h;
+	}
+	if (y < 0) {
+		h += y;
+		y = 0;
+	}
+	if (y + h > height) {
+		h = height - y;
+	}
+
+	if((w <= 0) || (h <= 0)) {
+		return;
+	}
+
+	if(index_bounds) {
+		Mark_Index(index, x, y, x + w - 1, y + h - 1);
+	}
+
+	for(int16_t j = y; j < y + h; j++) {
+		uint8_t *row = buffer + (int32_t)j * stride;
+
+		if(bits == 8) {
+			memset(row + x, index, w);
+			continue;
+		}
+
+		// 4 bits: an odd pixel at each end, whole bytes in between
+		int16_t i = x;
+		int16_t end = x + w;
+
+		if(i & 1) {
+			row[i / 2] = (row[i / 2] & 0xF0) | (index & 0x0F);
+			i++;
+		}
+		if(end - i >= 2) {
+			memset(row + i / 2, (index << 4) | (index & 0x0F), (end - i) / 2);
+			i += (end - i) & ~1;
+		}
+		if(i < end) {
+			row[i / 2] = (row[i / 2] & 0x0F) | (index << 4);
+		}
+	}
+}
+
+/*!
+ * @brief Set the window that Push_Any_Color() fills, left to right and then
+ *   top to bottom, the same as the display's memory write
+ */
+void LCDWIKI_Indexed_Canvas::Set_Addr_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	win_x1 = x1;
+	win_y1 = y1;
+	win_x2 = x2;
+	win_y2 = y2;
+	cur_x = x1;
+	cur_y = y1;
+}
+
+/*!
+ * @brief Write palette indices into the window set by Set_Addr_Window(), 
+ *   wrapping at the right hand edge of the window
+ *
+ * @param block The palette indices, one to a uint16_t
+ * @param n The number of indices
+ * @param first Start again from the top left of the window
+ * @param flags 00000001 - the block is in PROGMEM, else RAM
+ */
+void LCDWIKI_Indexed_Canvas::Push_Any_Color(uint16_t *block, int16_t n, bool first, uint8_t flags) {
+	bool isconst = flags & 1;
+
+	if(first) {
+		cur_x = win_x1;
+		cur_y = win_y1;
+	}
+
+	while(n-- > 0) {
+		Write_Next(isconst ? pgm_read_word(block++) : *block++);
+	}
+}
+
+/*!
+ * @brief Copy the palette indices of a rectangle of the canvas out to block,
+ *   row by row.  Pixels off the canvas read as 0.
+ *
+ * @return 0, the same as LCDWIKI_SPI::Read_GRAM()
+ */
+int16_t LCDWIKI_Indexed_Canvas::Read_GRAM(int16_t x, int16_t y, uint16_t *block, int16_t w, int16_t h) {
+	for(int16_t j = 0; j < h; j++) {
+		for(int16_t i = 0; i < w; i++) {
+			*block++ = Read_Pixel(x + i, y + j);
+		}
+	}
+
+	return 0;
+}
+
+int16_t LCDWIKI_Indexed_Canvas::Get_Height(void) const {
+	return height;
+}
+
+int16_t LCDWIKI_Indexed_Canvas::Get_Width(void) const {
+	return width;
+}
+
+/*!
+ * @brief Set the palette, which is used (not copied) until it is next set
+ *
+ * @param map The rgb565 colours, two bytes each with the high byte first
+ * @param entries The number of colours, up to 16 at 4 bits or 256 at 8 bits
+ * @param flags 00000001 - the map is in PROGMEM, else RAM
+ */
+void LCDWIKI_Indexed_Canvas::Set_Palette(const uint8_t *map, uint16_t entries, uint8_t flags) {
+	palette = map;
+	this->entries = entries;
+	palette_const = flags & 1;
+}
+
+/*!
+ * @brief Use the colour map of an image in the LCDWIKI_SPI::Push_Indexed_Image()
+ *   format as the palette
+ *
+ * @param block The image
+ * @param flags 00000001 - the image is in PROGMEM, else RAM
+ *
+ * @return whether the image has a colour map that fits the canvas
+ */
+boolean LCDWIKI_Indexed_Canvas::Set_Palette_From_Image(const uint8_t *block, uint8_t flags) {
+	uint16_t w;
+	uint16_t h;
+	uint8_t numEntries;
+	const uint8_t *map = lcd_read_indexed_header(block, flags, w, h, numEntries);
+
+	if(numEntries > (1 << bits)) {
+		return false;
+	}
+
+	Set_Palette(map, numEntries, flags);
+	return true;
+}
+
+/*!
+ * @brief Draw an image in the LCDWIKI_SPI::Push_Indexed_Image() format, 
+ *   cropped to the canvas.  Its colour indices are copied across as they 
+ *   are, so the image should share the canvas palette 
+ *   (see Set_Palette_From_Image()).
+ *
+ * @param x The left of the image
+ * @param y The top of the image
+ * @param block The image
+ * @param flags 00000001 - the image is in PROGMEM, else RAM
+ */
+void LCDWIKI_Indexed_Canvas::Draw_Indexed_Image(int16_t x, int16_t y, const uint8_t *block, uint8_t flags) {
+	bool isconst = flags & 1;
+	uint16_t w;
+	uint16_t h;
+	uint8_t numEntries;
+	uint8_t numberToDraw;
+
+	lcd_read_indexed_header(block, flags, w, h, numEntries);
+
+	#define NEXT_BYTE() (isconst ? pgm_read_byte(block++) : *block++)
+
+	Set_Addr_Window(x, y, x + w - 1, y + h - 1);
+
+	int32_t numPixels = (int32_t)w * h;
+	while(numPixels > 0) {
+		numberToDraw = NEXT_BYTE();
+
+		if(numberToDraw & 0x80) {
+			// a run of the one index
+			numberToDraw -= 0x80;
+			numPixels -= numberToDraw;
+
+			uint8_t index = NEXT_BYTE();
+			while(numberToDraw-- > 0) {
+				Write_Next(index);
+			}
+		} else {
+			numPixels -= numberToDraw;
+
+			while(numberToDraw-- > 0) {
+				Write_Next(NEXT_BYTE());
+			}
+		}
+	}
+
+	#undef NEXT_BYTE
+}
+
+/*!
+ * @brief Get the palette index of one pixel, 0 if x, y is off the canvas
+ */
+uint8_t LCDWIKI_Indexed_Canvas::Read_Pixel(int16_t x, int16_t y) const {
+	if((x < 0) || (y < 0) || (x >= width) || (y >= height)) {
+		return 0;
+	}
+
+	return Get_Index(x, y);
+}
+
+/*!
+ * @brief Get the buffer that the canvas draws to
+ */
+uint8_t *LCDWIKI_Indexed_Canvas::Get_Buffer(void) const {
+	return buffer;
+}
+
+/*!
+ * @brief Get the bits per pixel, 4 or 8
+ */
+uint8_t LCDWIKI_Indexed_Canvas::Get_Bits(void) const {
+	return bits;
+}
+
+/*!
+ * @brief Change one colour of the palette, which must be in RAM.  This only
+ *   changes the canvas, see LCDWIKI_SPI::Set_Palette_Entry() to recolour 
+ *   the display as well.
+ *
+ * @param index The palette index
+ * @param color The new rgb565 colour
+ *
+ * @return false if the palette is in PROGMEM or is too short for index
+ */
+boolean LCDWIKI_Indexed_Canvas::Set_Palette_Entry(uint8_t index, uint16_t color) {
+	if(palette_const || (index >= entries)) {
+		return false;
+	}
+
+	uint8_t *c = (uint8_t *)palette + index * 2;
+	c[0] = color >> 8;
+	c[1] = color;
+	return true;
+}
+
+/*!
+ * @brief Keep track of where each palette index is used, from now on.  The
+ *   map is built from the canvas as it is now, and then grows with each 
+ *   drawing call.  Drawing over an index does not shrink its bounds, so 
+ *   call Rebuild_Index_Map() once in a while if indices are often drawn 
+ *   over.
+ *
+ * @param bounds The bounds of each index, 16 at 4 bits or 256 at 8 bits,
+ *   or NULL to stop keeping the map
+ * @param rows One bit for each row of the canvas for each index, 
+ *   (height + 7) / 8 bytes an index, or NULL to only keep the bounds
+ */
+void LCDWIKI_Indexed_Canvas::Set_Index_Map(lcd_rect *bounds, uint8_t *rows) {
+	index_bounds = bounds;
+	index_rows = bounds ? rows : NULL;
+	Rebuild_Index_Map();
+}
+
+/*!
+ * @brief Build the index map again from the pixels of the canvas, which
+ *   drops anything that has since been drawn over
+ */
+void LCDWIKI_Indexed_Canvas::Rebuild_Index_Map(void) {
+	uint16_t count = 1 << bits;
+
+	if(!index_bounds) {
+		return;
+	}
+
+	for(uint16_t i = 0; i < count; i++) {
+		index_bounds[i].x1 = width;
+		index_bounds[i].y1 = height;
+		index_bounds[i].x2 = -1;
+		index_bounds[i].y2 = -1;
+	}
+	if(index_rows) {
+		memset(index_rows, 0, count * ((height + 7) / 8));
+	}
+
+	for(int16_t y = 0; y < height; y++) {
+		for(int16_t x = 0; x < width; x++) {
+			Mark_Index(Get_Index(x, y), x, y, x, y);
+		}
+	}
+}
+
+/*!
+ * @brief Get the bounds of the pixels of one palette index, empty 
+ *   (x1 > x2) if it is not used, and the whole canvas with no index map
+ */
+lcd_rect LCDWIKI_Indexed_Canvas::Get_Index_Bounds(uint8_t index) const {
+	if(!index_bounds) {
+		lcd_rect r = { 0, 0, (int16_t)(width - 1), (int16_t)(height - 1) };
+		return r;
+	}
+
+	return index_bounds[index & ((1 << bits) - 1)];
+}
+
+// set one pixel to a palette index, if it is on the canvas
+void LCDWIKI_Indexed_Canvas::Put(int16_t x, int16_t y, uint8_t index) {
+	if((x < 0) || (y < 0) || (x >= width) || (y >= height)) {
+		return;
+	}
+
+	if(index_bounds) {
+		Mark_Index(index, x, y, x, y);
+	}
+
+	if(bits == 8) {
+		buffer[(int32_t)y * stride + x] = index;
+		return;
+	}
+
+	uint8_t *b = &buffer[(int32_t)y * stride + x / 2];
+	if(x & 1) {
+		*b = (*b & 0xF0) | (index & 0x0F);
+	} else {
+		*b = (*b & 0x0F) | (index << 4);
+	}
+}
+
+// write the next index of the window, as Push_Any_Color() does
+void LCDWIKI_Indexed_Canvas::Write_Next(uint8_t index) {
+	Put(cur_x, cur_y, index);
+	if(++cur_x > win_x2) {
+		cur_x = win_x1;
+		if(++cur_y > win_y2) {
+			cur_y = win_y1;
+		}
+	}
+}
+
+// add a rectangle of the canvas to where an index is used
+void LCDWIKI_Indexed_Canvas::Mark_Index(uint8_t index, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	index &= (1 << bits) - 1;
+
+	lcd_rect &r = index_bounds[index];
+	if(x1 < r.x1) {
+		r.x1 = x1;
+	}
+	if(y1 < r.y1) {
+		r.y1 = y1;
+	}
+	if(x2 > r.x2) {
+		r.x2 = x2;
+	}
+	if(y2 > r.y2) {
+		r.y2 = y2;
+	}
+
+	if(index_rows) {
+		uint8_t *row = index_rows + index * ((height + 7) / 8);
+		for(int16_t y = y1; y <= y2; y++) {
+			row[y / 8] |= 1 << (y & 7);
+		}
+	}
+}
@@ -0,0 +1,313 @@
+// Off screen RAM canvas for the Lcdwiki GUI library
+// MIT license
+
+#ifndef _LCDWIKI_CANVAS_H_
+#define _LCDWIKI_CANVAS_H_
+
+#if ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#ifdef __AVR__
+	#include <avr/pgmspace.h>
+#elif defined(ESP8266)
+	#include <pgmspace.h>
+#elif !defined(pgm_read_word)
+	#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+	#define pgm_read_word(addr) (*(const unsigned short *)(addr))
+#endif
+
+#include "LCDWIKI_GUI.h"
+#include "LCDWIKI_Damage.h"
+
+/*!
+ * @brief An rgb565 canvas in RAM that everything in LCDWIKI_GUI can draw to,
+ *   in the same way as to the display.  Draw the whole of a UI element to
+ *   the canvas and then send it to the display in one go with
+ *   LCDWIKI_SPI::Blit_Canvas(), rather than paying for an address window
+ *   on every line and character (and watching it being drawn).
+ *
+ *   The buffer is supplied by the sketch, and must hold width * height
+ *   uint16_t colours, one row after the other:
+ *
+ *     uint16_t icon_buffer[32 * 32];
+ *     LCDWIKI_Canvas icon(32, 32, icon_buffer);
+ *
+ *   Set_View() makes the canvas stand in for part of a bigger area, such as 
+ *   one band of the display (see LCDWIKI_SPI::Render_Bands()).
+ *
+ *   With a damage list set (Set_Damage()), the canvas adds the bounds of the
+ *   pixels that each drawing call actually changed to it.
+ */
+class LCDWIKI_Canvas:public LCDWIKI_GUI {
+	public:
+		LCDWIKI_Canvas(int16_t wid, int16_t heg, uint16_t *buffer);
+
+		uint16_t Color_To_565(uint8_t r, uint8_t g, uint8_t b);
+		void Draw_Pixe(int16_t x, int16_t y, uint16_t color);
+		void Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+		void Set_Addr_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+		void Push_Any_Color(uint16_t *block, int16_t n, bool first, uint8_t flags);
+		int16_t Read_GRAM(int16_t x, int16_t y, uint16_t *block, int16_t w, int16_t h);
+		int16_t Get_Height(void) const;
+		int16_t Get_Width(void) const;
+
+		uint16_t Read_Pixel(int16_t x, int16_t y) const;
+		uint16_t *Get_Buffer(void) const;
+		int16_t Get_Buffer_Width(void) const;
+		int16_t Get_Buffer_Height(void) const;
+		void Set_View(int16_t x, int16_t y, int16_t w, int16_t h);
+
+		void Set_Damage(LCDWIKI_Damage *damage);
+		void Restart_Window(void);
+		void Commit_Damage(void);
+
+		/*!
+		 * @brief Write the next colour of the window set by Set_Addr_Window(),
+		 *   the same as Push_Any_Color() does.  The damage is only added to 
+		 *   the damage list by Commit_Damage().
+		 */
+		inline void Write_Next(uint16_t color) {
+			Put(cur_x, cur_y, color);
+			if(++cur_x > win_x2) {
+				cur_x = win_x1;
+				if(++cur_y > win_y2) {
+					cur_y = win_y1;
+				}
+			}
+		}
+
+	protected:
+		int16_t width;
+		int16_t height;
+		uint16_t *buffer;
+
+		// the area that the canvas stands in for, and where in it the buffer
+		// is, see Set_View()
+		int16_t view_x;
+		int16_t view_y;
+		int16_t view_w;
+		int16_t view_h;
+
+		// the window that Push_Any_Color() writes to, and where it is up to
+		int16_t win_x1;
+		int16_t win_y1;
+		int16_t win_x2;
+		int16_t win_y2;
+		int16_t cur_x;
+		int16_t cur_y;
+
+		// where the changes go, and the bounds of the changes that have not
+		// been added to it yet (empty while dmg_x1 > dmg_x2)
+		LCDWIKI_Damage *damage;
+		int16_t dmg_x1;
+		int16_t dmg_y1;
+		int16_t dmg_x2;
+		int16_t dmg_y2;
+
+		// set one pixel, and note it as damage if that changed it
+		inline void Put(int16_t x, int16_t y, uint16_t color) {
+			if((x < 0) || (y < 0) || (x >= width) || (y >= height)) {
+				return;
+			}
+
+			uint16_t *p = &buffer[(int32_t)y * width + x];
+			if(*p == color) {
+				return;
+			}
+			*p = color;
+
+			if(damage) {
+				if(x < dmg_x1) {
+					dmg_x1 = x;
+				}
+				if(x > dmg_x2) {
+					dmg_x2 = x;
+				}
+				if(y < dmg_y1) {
+					dmg_y1 = y;
+				}
+				if(y > dmg_y2) {
+					dmg_y2 = y;
+				}
+			}
+		}
+};
+
+// what LCDWIKI_Mono_Canvas::Rect_Op() does to the pixels
+#define MONO_CLEAR  0
+#define MONO_SET    1
+#define MONO_INVERT 2
+
+/*!
+ * @brief A 1 bit per pixel canvas in RAM, laid out the same as the SH1106 
+ *   RAM: each byte is 8 rows of one column (bit 0 at the top), a page of 
+ *   width bytes at a time.  Any colour other than 0 sets a pixel.  Send it
+ *   to a colour display with LCDWIKI_SPI::Blit_Mono_Canvas(), in any two 
+ *   colours.
+ *
+ *   The buffer is supplied by the sketch, and must hold 
+ *   width * ((height + 7) / 8) bytes.  It can be the same storage as the 
+ *   SH1106 buffer (see LCDWIKI_SPI::Set_SH1106_Buffer()).
+ */
+class LCDWIKI_Mono_Canvas:public LCDWIKI_GUI {
+	public:
+		LCDWIKI_Mono_Canvas(int16_t wid, int16_t heg, uint8_t *buffer);
+
+		uint16_t Color_To_565(uint8_t r, uint8_t g, uint8_t b);
+		void Draw_Pixe(int16_t x, int16_t y, uint16_t color);
+		void Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+		void Set_Addr_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+		void Push_Any_Color(uint16_t *block, int16_t n, bool first, uint8_t flags);
+		int16_t Read_GRAM(int16_t x, int16_t y, uint16_t *block, int16_t w, int16_t h);
+		int16_t Get_Height(void) const;
+		int16_t Get_Width(void) const;
+
+		void Invert_Rect(int16_t x, int16_t y, int16_t w, int16_t h);
+		void Draw_Bitmap(int16_t x, int16_t y, uint8_t width, uint8_t height, const uint8_t *BMP, uint8_t mode);
+		boolean Read_Pixel(int16_t x, int16_t y) const;
+		uint8_t *Get_Buffer(void) const;
+
+		static void Rect_Op(uint8_t *buffer, int16_t stride, int16_t x, int16_t y, int16_t w, int16_t h, uint8_t op, 
+				uint8_t *dirty_first, uint8_t *dirty_last);
+		static void Bitmap_Op(uint8_t *buffer, int16_t stride, int16_t pages, int16_t x, int16_t y, uint8_t width, uint8_t height, 
+				const uint8_t *BMP, uint8_t mode, uint8_t *dirty_first, uint8_t *dirty_last);
+
+	protected:
+		int16_t width;
+		int16_t height;
+		uint8_t *buffer;
+
+		// the window that Push_Any_Color() writes to, and where it is up to
+		int16_t win_x1;
+		int16_t win_y1;
+		int16_t win_x2;
+		int16_t win_y2;
+		int16_t cur_x;
+		int16_t cur_y;
+
+		boolean Clip(int16_t &x, int16_t &y, int16_t &w, int16_t &h) const;
+};
+
+/*!
+ * @brief A 4 or 8 bit per pixel canvas in RAM, where each pixel is an index
+ *   into a palette of up to 16 or 256 rgb565 colours.  It is a quarter (or
+ *   half) of the size of an LCDWIKI_Canvas, so a whole 320x480 display fits
+ *   in 76800 bytes at 4 bits.  Send it to the display with 
+ *   LCDWIKI_SPI::Blit_Indexed_Canvas(), which looks each pixel up in the 
+ *   palette as it goes.
+ *
+ *   The colours passed to the drawing functions are palette indices, and 
+ *   Color_To_565() gives the index of the nearest colour in the palette.
+ *   The palette is in the same format as the colour map of the images for
+ *   LCDWIKI_SPI::Push_Indexed_Image(), so it can be taken straight from 
+ *   one (Set_Palette_From_Image()), and the images drawn with 
+ *   Draw_Indexed_Image() copy their indices across unchanged.
+ *
+ *   The buffer is supplied by the sketch, and must hold height rows of 
+ *   (width * bits + 7) / 8 bytes (the left pixel of each byte is in the 
+ *   high nibble at 4 bits).
+ *
+ *   With an index map set (Set_Index_Map()), the canvas keeps the bounds of
+ *   each index and the rows it is used on as it is drawn, so that 
+ *   LCDWIKI_SPI::Set_Palette_Entry() can recolour an index on the display
+ *   by sending only the spans that use it.
+ */
+class LCDWIKI_Indexed_Canvas:public LCDWIKI_GUI {
+	public:
+		LCDWIKI_Indexed_Canvas(int16_t wid, int16_t heg, uint8_t bits, uint8_t *buffer);
+
+		uint16_t Color_To_565(uint8_t r, uint8_t g, uint8_t b);
+		void Draw_Pixe(int16_t x, int16_t y, uint16_t color);
+		void Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+		void Set_Addr_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+		void Push_Any_Color(uint16_t *block, int16_t n, bool first, uint8_t flags);
+		int16_t Read_GRAM(int16_t x, int16_t y, uint16_t *block, int16_t w, int16_t h);
+		int16_t Get_Height(void) const;
+		int16_t Get_Width(void) const;
+
+		void Set_Palette(const uint8_t *map, uint16_t entries, uint8_t flags);
+		boolean Set_Palette_From_Image(const uint8_t *block, uint8_t flags);
+		void Draw_Indexed_Image(int16_t x, int16_t y, const uint8_t *block, uint8_t flags);
+		uint8_t Read_Pixel(int16_t x, int16_t y) const;
+		uint8_t *Get_Buffer(void) const;
+		uint8_t Get_Bits(void) const;
+
+		boolean Set_Palette_Entry(uint8_t index, uint16_t color);
+		void Set_Index_Map(lcd_rect *bounds, uint8_t *rows);
+		void Rebuild_Index_Map(void);
+		lcd_rect Get_Index_Bounds(uint8_t index) const;
+
+		/*!
+		 * @brief Whether an index may be used on row y, always true with no
+		 *   row map
+		 */
+		inline boolean Index_In_Row(uint8_t index, int16_t y) const {
+			if(!index_rows) {
+				return true;
+			}
+			return (index_rows[index * ((height + 7) / 8) + y / 8] >> (y & 7)) & 1;
+		}
+
+		/*!
+		 * @brief Get the index of one pixel, with no check that x, y is on 
+		 *   the canvas
+		 */
+		inline uint8_t Get_Index(int16_t x, int16_t y) const {
+			if(bits == 8) {
+				return buffer[(int32_t)y * stride + x];
+			}
+
+			uint8_t b = buffer[(int32_t)y * stride + x / 2];
+			return (x & 1) ? (b & 0x0F) : (b >> 4);
+		}
+
+		/*!
+		 * @brief Get the rgb565 colour of a palette entry, 0 (black) past 
+		 *   the end of the palette
+		 */
+		inline uint16_t Get_Color(uint8_t index) const {
+			if(index >= entries) {
+				return 0;
+			}
+
+			const uint8_t *c = palette + index * 2;
+			if(palette_const) {
+				return (pgm_read_byte(c) << 8) | pgm_read_byte(c + 1);
+			}
+			return (c[0] << 8) | c[1];
+		}
+
+	protected:
+		int16_t width;
+		int16_t height;
+		uint8_t bits;
+		int16_t stride;
+		uint8_t *buffer;
+
+		// the palette, entries rgb565 colours high byte first, in PROGMEM 
+		// if palette_const is set
+		const uint8_t *palette;
+		uint16_t entries;
+		boolean palette_const;
+
+		// the index map, see Set_Index_Map()
+		lcd_rect *index_bounds;
+		uint8_t *index_rows;
+
+		// the window that Push_Any_Color() writes to, and where it is up to
+		int16_t win_x1;
+		int16_t win_y1;
+		int16_t win_x2;
+		int16_t win_y2;
+		int16_t cur_x;
+		int16_t cur_y;
+
+		void Put(int16_t x, int16_t y, uint8_t index);
+		void Write_Next(uint8_t index);
+		void Mark_Index(uint8_t index, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+};
+
+#endif
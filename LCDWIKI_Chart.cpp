@@ -0,0 +1,263 @@
+// Scrolling strip chart for the Lcdwiki SPI library
+// MIT license
+
+#include "LCDWIKI_Chart.h"
+
+/*!
+ * @brief Create a strip chart for a display, which is laid out by Begin()
+ *
+ * @param lcd The display
+ * @param header The rows of pixels at the top of the display (in rotation 
+ *   0) that the chart leaves alone
+ * @param footer The rows of pixels at the bottom of the display that the 
+ *   chart leaves alone
+ */
+LCDWIKI_Strip_Chart::LCDWIKI_Strip_Chart(LCDWIKI_SPI &lcd, int16_t header, int16_t footer)
+	: lcd(lcd) {
+	top = header;
+	this->footer = footer;
+	lines = 0;
+
+	bg = 0x0000;
+	grid = 0x4208;
+	grid_across = 0;
+	grid_along = 0;
+
+	range_min = 0;
+	range_max = 1023;
+
+	traces = 1;
+	for(uint8_t i = 0; i < CHART_MAX_TRACES; i++) {
+		colors[i] = 0xFFFF;
+		last[i] = -1;
+	}
+
+	hardware = false;
+	next = 0;
+	count = 0;
+}
+
+/*!
+ * @brief Set the colours of the background and the grid lines
+ */
+void LCDWIKI_Strip_Chart::Set_Colors(uint16_t bg, uint16_t grid) {
+	this->bg = bg;
+	this->grid = grid;
+}
+
+/*!
+ * @brief Set the spacing of the grid lines, 0 for none
+ *
+ * @param across Pixels between the grid lines that run along the chart
+ *   (marking values)
+ * @param along Samples between the grid lines that run across the chart
+ *   (marking time)
+ */
+void LCDWIKI_Strip_Chart::Set_Grid(int16_t across, int16_t along) {
+	grid_across = across;
+	grid_along = along;
+}
+
+/*!
+ * @brief Set the values at the left and right of the chart, values outside
+ *   of the range are drawn at the edge
+ */
+void LCDWIKI_Strip_Chart::Set_Range(int16_t min, int16_t max) {
+	range_min = min;
+	range_max = (max > min) ? max : min + 1;
+}
+
+/*!
+ * @brief Set the colour of a trace, which plots the values of it passed to
+ *   Add_Samples().  The traces in use are 0 up to the highest one set, 
+ *   trace 0 is drawn on top.
+ */
+void LCDWIKI_Strip_Chart::Set_Trace(uint8_t trace, uint16_t color) {
+	if(trace >= CHART_MAX_TRACES) {
+		return;
+	}
+
+	colors[trace] = color;
+	if(trace >= traces) {
+		traces = trace + 1;
+	}
+}
+
+/*!
+ * @brief Put the display in rotation 0, so that the lines of the chart are
+ *   along the hardware scroll, lay the chart out and clear it
+ */
+void LCDWIKI_Strip_Chart::Begin(void) {
+	if(lcd.Get_Rotation() != 0) {
+		lcd.Set_Rotation(0);
+	}
+
+	lines = lcd.Get_Height() - top - footer;
+	if(lines < 0) {
+		lines = 0;
+	}
+	hardware = lcd.Can_Vert_Scroll();
+
+	Clear();
+}
+
+/*!
+ * @brief Put the display's scroll back to normal.  The lines of the chart
+ *   stay where they are in GRAM, so they show out of order until they are
+ *   drawn over.
+ */
+void LCDWIKI_Strip_Chart::End(void) {
+	if(hardware) {
+		lcd.Vert_Scroll(0, lcd.Get_Height(), 0);
+	}
+	lines = 0;
+}
+
+/*!
+ * @brief Clear the chart, and start the traces again
+ */
+void LCDWIKI_Strip_Chart::Clear(void) {
+	next = 0;
+	count = 0;
+	for(uint8_t i = 0; i < CHART_MAX_TRACES; i++) {
+		last[i] = -1;
+	}
+
+	if(!lines) {
+		return;
+	}
+
+	lcd.Fill_Rect(0, top, lcd.Get_Width(), lines, bg);
+	if(hardware) {
+		// the next line to draw is at the top, the oldest on show
+		lcd.Vert_Scroll(top + lcd.Get_Scroll_Offset(), lines, 0);
+	}
+}
+
+/*!
+ * @brief Add a sample of trace 0, see Add_Samples()
+ */
+void LCDWIKI_Strip_Chart::Add_Sample(int16_t value) {
+	Add_Samples(&value);
+}
+
+/*!
+ * @brief Add a sample of each trace in use as the newest line of the chart.
+ *   Each trace is joined to where it was in the sample before.
+ *
+ * @param values A value for each trace
+ */
+void LCDWIKI_Strip_Chart::Add_Samples(const int16_t *values) {
+	int16_t x[CHART_MAX_TRACES];
+
+	if(!lines) {
+		return;
+	}
+
+	for(uint8_t i = 0; i < traces; i++) {
+		x[i] = Value_To_X(values[i]);
+	}
+
+	lcd.Begin_Batch();
+	Draw_Line(x);
+
+	next = (next + 1) % lines;
+	if(hardware) {
+		// scroll the line that was just drawn from the top to the bottom
+		lcd.Vert_Scroll(top + lcd.Get_Scroll_Offset(), lines, next);
+	}
+	lcd.End_Batch();
+
+	for(uint8_t i = 0; i < traces; i++) {
+		last[i] = x[i];
+	}
+	count++;
+}
+
+/*!
+ * @brief Get the number of samples that the chart shows
+ */
+int16_t LCDWIKI_Strip_Chart::Get_Lines(void) const {
+	return lines;
+}
+
+/*!
+ * @brief Get the y co-ordinate that a line of the chart is drawn at, 0 is
+ *   the oldest sample on show and Get_Lines() - 1 the newest.  With the 
+ *   hardware scroll this is the line's GRAM row, not where it is on the 
+ *   screen.
+ */
+int16_t LCDWIKI_Strip_Chart::Get_Line_Y(int16_t line) const {
+	return top + (next + line) % lines;
+}
+
+/*!
+ * @brief Whether the chart scrolls with the display's hardware scroll
+ */
+boolean LCDWIKI_Strip_Chart::Is_Hardware_Scroll(void) const {
+	return hardware;
+}
+
+// the column of the chart for a value
+int16_t LCDWIKI_Strip_Chart::Value_To_X(int16_t value) const {
+	if(value <= range_min) {
+		return 0;
+	}
+	if(value >= range_max) {
+		return lcd.Get_Width() - 1;
+	}
+
+	return (int32_t)(value - range_min) * (lcd.Get_Width() - 1) / (range_max - range_min);
+}
+
+// draw the next line of the chart, a run of each colour at a time
+void LCDWIKI_Strip_Chart::Draw_Line(const int16_t *x) {
+	int16_t w = lcd.Get_Width();
+	int16_t y = top + next;
+	boolean grid_line = grid_along && ((count % grid_along) == 0);
+	int16_t from[CHART_MAX_TRACES];
+	int16_t to[CHART_MAX_TRACES];
+	boolean first = true;
+
+	// each trace covers the columns from where it was to where it is
+	for(uint8_t i = 0; i < traces; i++) {
+		int16_t l = (last[i] < 0) ? x[i] : last[i];
+
+		from[i] = (l < x[i]) ? l : x[i];
+		to[i] = (l < x[i]) ? x[i] : l;
+	}
+
+	if(hardware) {
+		lcd.Set_Addr_Window(0, y, w - 1, y);
+	}
+
+	int16_t start = 0;
+	uint16_t run_color = 0;
+	for(int16_t i = 0; i <= w; i++) {
+		uint16_t color = bg;
+
+		if(i < w) {
+			if(grid_line || (grid_across && ((i % grid_across) == 0))) {
+				color = grid;
+			}
+			for(int8_t t = traces - 1; t >= 0; t--) {
+				if((i >= from[t]) && (i <= to[t])) {
+					color = colors[t];
+				}
+			}
+		}
+
+		if(i == 0) {
+			run_color = color;
+		} else if((i == w) || (color != run_color)) {
+			if(hardware) {
+				lcd.Push_Same_Color(run_color, i - start, first);
+			} else {
+				lcd.Fill_Rect(start, y, i - start, 1, run_color);
+			}
+			first = false;
+			start = i;
+			run_color = color;
+		}
+	}
+}
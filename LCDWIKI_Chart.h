@@ -0,0 +1,93 @@
+// Scrolling strip chart for the Lcdwiki SPI library
+// MIT license
+
+#ifndef _LCDWIKI_CHART_H_
+#define _LCDWIKI_CHART_H_
+
+#if ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "LCDWIKI_SPI.h"
+
+// The most traces that a strip chart plots
+#ifndef CHART_MAX_TRACES
+	#define CHART_MAX_TRACES 4
+#endif
+
+/*!
+ * @brief A strip chart for streaming samples, in the part of the display 
+ *   between a fixed header and footer.  Each sample is one line across the
+ *   display, with the value running from left (the bottom of the range) to
+ *   right, and the lines move up the display as samples are added, along 
+ *   the hardware scroll.  Mount the display on its side for a chart that 
+ *   runs across.
+ *
+ *   Where the display can (LCDWIKI_SPI::Can_Vert_Scroll()), each sample is
+ *   drawn as a single one line window into the GRAM line that has just 
+ *   scrolled off the top, and then only the scroll start address is sent,
+ *   so adding a sample costs the same however big the chart is.  Otherwise
+ *   the chart sweeps down the display, drawing over the oldest sample.
+ *
+ *     LCDWIKI_Strip_Chart chart(my_lcd, 0, 0);
+ *     chart.Set_Range(0, 1023);
+ *     chart.Set_Trace(0, GREEN);
+ *     chart.Begin();
+ *     chart.Add_Sample(analogRead(A0));
+ */
+class LCDWIKI_Strip_Chart {
+	public:
+		LCDWIKI_Strip_Chart(LCDWIKI_SPI &lcd, int16_t header, int16_t footer);
+
+		void Set_Colors(uint16_t bg, uint16_t grid);
+		void Set_Grid(int16_t across, int16_t along);
+		void Set_Range(int16_t min, int16_t max);
+		void Set_Trace(uint8_t trace, uint16_t color);
+		void Begin(void);
+		void End(void);
+		void Clear(void);
+
+		void Add_Sample(int16_t value);
+		void Add_Samples(const int16_t *values);
+
+		int16_t Get_Lines(void) const;
+		int16_t Get_Line_Y(int16_t line) const;
+		boolean Is_Hardware_Scroll(void) const;
+
+	protected:
+		LCDWIKI_SPI &lcd;
+
+		// the chart area, one line for each sample from top, leaving footer
+		// rows below it
+		int16_t top;
+		int16_t footer;
+		int16_t lines;
+
+		uint16_t bg;
+		uint16_t grid;
+		int16_t grid_across;
+		int16_t grid_along;
+
+		int16_t range_min;
+		int16_t range_max;
+
+		// the traces that are in use, their colours, and the column each
+		// was at for the last sample (-1 before the first)
+		uint8_t traces;
+		uint16_t colors[CHART_MAX_TRACES];
+		int16_t last[CHART_MAX_TRACES];
+
+		boolean hardware;
+
+		// the GRAM line that the next sample goes to, and the number of 
+		// samples so far (for the grid lines along the chart)
+		int16_t next;
+		uint16_t count;
+
+		int16_t Value_To_X(int16_t value) const;
+		void Draw_Line(const int16_t *x);
+};
+
+#endif
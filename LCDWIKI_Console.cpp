@@ -0,0 +1,231 @@
+// Scrolling text console for the Lcdwiki SPI library
+// MIT license
+
+#include "LCDWIKI_Console.h"
+
+/*!
+ * @brief Create a console for a display, which is laid out by Begin()
+ *
+ * @param lcd The display
+ * @param header The rows of pixels at the top of the display that the 
+ *   console leaves alone
+ * @param footer The rows of pixels at the bottom of the display that the
+ *   console leaves alone (any rows left over from whole lines are added)
+ * @param size The text size, lines are 8 * size pixels high
+ */
+LCDWIKI_Console::LCDWIKI_Console(LCDWIKI_SPI &lcd, int16_t header, int16_t footer, uint8_t size)
+	: lcd(lcd) {
+	top = header;
+	this->footer = footer;
+	this->size = size ? size : 1;
+	line_h = 8 * this->size;
+	char_w = 6 * this->size;
+	rows = 0;
+	cols = 0;
+
+	fg = 0xFFFF;
+	bg = 0x0000;
+	text = NULL;
+	hardware = false;
+
+	first = 0;
+	row = 0;
+	col = 0;
+	pending = false;
+}
+
+/*!
+ * @brief Set the colours of the text and of the console background, for 
+ *   the characters written from now on
+ */
+void LCDWIKI_Console::Set_Colors(uint16_t fg, uint16_t bg) {
+	this->fg = fg;
+	this->bg = bg;
+}
+
+/*!
+ * @brief Keep the text of the console in a buffer, so that it can be 
+ *   scrolled where there is no hardware scroll.  Set it before Begin().
+ *
+ * @param buffer Get_Rows() * Get_Cols() characters, or NULL
+ */
+void LCDWIKI_Console::Set_Text_Buffer(char *buffer) {
+	text = buffer;
+}
+
+/*!
+ * @brief Lay the console out on the display as it is now (size and 
+ *   rotation), and clear it
+ */
+void LCDWIKI_Console::Begin(void) {
+	rows = (lcd.Get_Height() - top - footer) / line_h;
+	if(rows < 0) {
+		rows = 0;
+	}
+	cols = lcd.Get_Width() / char_w;
+	hardware = lcd.Can_Vert_Scroll();
+
+	Clear();
+}
+
+/*!
+ * @brief Put the display's scroll back to normal.  The lines of the 
+ *   console stay where they are in GRAM, so they show out of order until
+ *   they are drawn over.
+ */
+void LCDWIKI_Console::End(void) {
+	if(hardware) {
+		lcd.Vert_Scroll(0, lcd.Get_Height(), 0);
+	}
+	rows = 0;
+}
+
+/*!
+ * @brief Clear the console, and move the cursor to the top left
+ */
+void LCDWIKI_Console::Clear(void) {
+	first = 0;
+	row = 0;
+	col = 0;
+	pending = false;
+
+	if(!rows) {
+		return;
+	}
+
+	if(text) {
+		memset(text, 0, rows * cols);
+	}
+
+	lcd.Fill_Rect(0, top, lcd.Get_Width(), rows * line_h, bg);
+	if(hardware) {
+		lcd.Vert_Scroll(top + lcd.Get_Scroll_Offset(), rows * line_h, 0);
+	}
+}
+
+/*!
+ * @brief Write one character at the cursor.  '\n' starts a new line, '\r' 
+ *   goes back to the start of the line, and a line that is too long wraps.
+ */
+void LCDWIKI_Console::Write(char c) {
+	if(!rows) {
+		return;
+	}
+
+	if(c == '\n') {
+		if(pending) {
+			New_Line();
+		}
+		pending = true;
+		return;
+	}
+	if(c == '\r') {
+		col = 0;
+		return;
+	}
+
+	if(pending || (col >= cols)) {
+		New_Line();
+	}
+
+	// the line was cleared by New_Line(), so only the text is drawn
+	lcd.Draw_Char(col * char_w, Get_Row_Y(row), c, fg, bg, size, true);
+	if(text) {
+		text[Slot(row) * cols + col] = c;
+	}
+	col++;
+}
+
+/*!
+ * @brief Write a string at the cursor, see Write()
+ */
+void LCDWIKI_Console::Print(const char *st) {
+	lcd.Begin_Batch();
+	while(*st) {
+		Write(*st++);
+	}
+	lcd.End_Batch();
+}
+
+/*!
+ * @brief Write a string and then a line feed
+ */
+void LCDWIKI_Console::Print_Line(const char *st) {
+	Print(st);
+	Write('\n');
+}
+
+int16_t LCDWIKI_Console::Get_Rows(void) const {
+	return rows;
+}
+
+int16_t LCDWIKI_Console::Get_Cols(void) const {
+	return cols;
+}
+
+/*!
+ * @brief Get the y co-ordinate to draw a logical row of the console at (0 
+ *   is the top row on show).  With the hardware scroll this is the row's
+ *   line slot in GRAM, not where it is on the screen.
+ */
+int16_t LCDWIKI_Console::Get_Row_Y(int16_t row) const {
+	return top + (hardware ? Slot(row) : row) * line_h;
+}
+
+/*!
+ * @brief Whether the console scrolls with the display's hardware scroll
+ */
+boolean LCDWIKI_Console::Is_Hardware_Scroll(void) const {
+	return hardware;
+}
+
+// move the cursor to the start of the next line, scrolling if it is on the
+// bottom line, and clear that line
+void LCDWIKI_Console::New_Line(void) {
+	pending = false;
+	col = 0;
+
+	if(row < rows - 1) {
+		row++;
+	} else if(hardware) {
+		// the line slot at the top becomes the bottom line, clear it before
+		// it scrolls into view and only send the new start address
+		lcd.Fill_Rect(0, top + first * line_h, lcd.Get_Width(), line_h, bg);
+		if(text) {
+			memset(text + first * cols, 0, cols);
+		}
+		first = (first + 1) % rows;
+		lcd.Vert_Scroll(top + lcd.Get_Scroll_Offset(), rows * line_h, first * line_h);
+		return;
+	} else if(text) {
+		// move every line up a row on the screen, the text stays put
+		first = (first + 1) % rows;
+		lcd.Begin_Batch();
+		for(int16_t r = 0; r < rows - 1; r++) {
+			Draw_Row(r);
+		}
+		lcd.End_Batch();
+	} else {
+		// nothing to scroll from, start again at the top
+		lcd.Fill_Rect(0, top, lcd.Get_Width(), rows * line_h, bg);
+		row = 0;
+		return;
+	}
+
+	if(text) {
+		memset(text + Slot(row) * cols, 0, cols);
+	}
+	lcd.Fill_Rect(0, Get_Row_Y(row), lcd.Get_Width(), line_h, bg);
+}
+
+// draw a logical row of the console from the text buffer
+void LCDWIKI_Console::Draw_Row(int16_t row) {
+	const char *line = text + Slot(row) * cols;
+	int16_t y = Get_Row_Y(row);
+	int16_t i;
+
+	for(i = 0; (i < cols) && line[i]; i++) {
+		lcd.Draw_Char(i * char_w, y, line[i], fg, bg, size, false);
+	}
+	lcd.Fill_Rect(i * char_w, y, lcd.Get_Width() - i * char_w, line_h, bg);
+}
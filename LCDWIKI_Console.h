@@ -0,0 +1,90 @@
+// Scrolling text console for the Lcdwiki SPI library
+// MIT license
+
+#ifndef _LCDWIKI_CONSOLE_H_
+#define _LCDWIKI_CONSOLE_H_
+
+#if ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#include "LCDWIKI_SPI.h"
+
+/*!
+ * @brief A text console in the part of the display between a fixed header 
+ *   and footer, which scrolls up a line at a time as lines are added.
+ *
+ *   Where the display can (LCDWIKI_SPI::Can_Vert_Scroll()), the console 
+ *   uses the hardware scroll: each new line is drawn into the GRAM row that
+ *   has just scrolled off the top, and only the scroll start address is 
+ *   sent, so adding a line costs the same however many lines are on show.
+ *   Otherwise each scroll redraws the console from a text buffer supplied
+ *   by the sketch (Set_Text_Buffer()), or starts again from the top with no
+ *   buffer.  On the SH1106 the lines are drawn to its RAM buffer, so call
+ *   LCDWIKI_SPI::SH1106_Display() to show them.
+ *
+ *     LCDWIKI_Console console(my_lcd, 16, 16, 1);
+ *     console.Begin();
+ *     console.Print_Line("ready");
+ */
+class LCDWIKI_Console {
+	public:
+		LCDWIKI_Console(LCDWIKI_SPI &lcd, int16_t header, int16_t footer, uint8_t size = 1);
+
+		void Set_Colors(uint16_t fg, uint16_t bg);
+		void Set_Text_Buffer(char *buffer);
+		void Begin(void);
+		void End(void);
+		void Clear(void);
+
+		void Write(char c);
+		void Print(const char *st);
+		void Print_Line(const char *st);
+
+		int16_t Get_Rows(void) const;
+		int16_t Get_Cols(void) const;
+		int16_t Get_Row_Y(int16_t row) const;
+		boolean Is_Hardware_Scroll(void) const;
+
+	protected:
+		LCDWIKI_SPI &lcd;
+
+		// the scroll area, whole lines of line_h pixels from top, leaving at
+		// least footer rows below it
+		int16_t top;
+		int16_t footer;
+		int16_t rows;
+		int16_t cols;
+		uint8_t size;
+		int16_t line_h;
+		int16_t char_w;
+
+		uint16_t fg;
+		uint16_t bg;
+
+		// the rows * cols characters on show, a row for each GRAM line 
+		// slot, with the unused end of each row 0
+		char *text;
+
+		boolean hardware;
+
+		// the GRAM line slot at the top of the scroll area, and the logical 
+		// row and column of the cursor (a line feed only moves it when the 
+		// next character comes, so the last line stays at the bottom)
+		int16_t first;
+		int16_t row;
+		int16_t col;
+		boolean pending;
+
+		void New_Line(void);
+		void Draw_Row(int16_t row);
+
+		// the GRAM line slot of a logical row
+		inline int16_t Slot(int16_t row) const {
+			return (first + row) % rows;
+		}
+};
+
+#endif
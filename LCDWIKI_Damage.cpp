@@ -0,0 +1,155 @@
+// Damage (dirty rectangle) tracking for the Lcdwiki GUI library
+// MIT license
+
+#include "LCDWIKI_Damage.h"
+
+// whether two rectangles overlap, or sit side by side sharing an edge (only
+// touching at a corner does not count, merging those would add clean pixels)
+static bool Rects_Touch(const lcd_rect &a, const lcd_rect &b) {
+	bool x_overlap = (a.x1 <= b.x2) && (b.x1 <= a.x2);
+	bool y_overlap = (a.y1 <= b.y2) && (b.y1 <= a.y2);
+	bool x_touch = (a.x1 <= b.x2 + 1) && (b.x1 <= a.x2 + 1);
+	bool y_touch = (a.y1 <= b.y2 + 1) && (b.y1 <= a.y2 + 1);
+
+	return((x_overlap && y_touch) || (x_touch && y_overlap));
+}
+
+// grow a to cover b as well
+static void Rect_Union(lcd_rect &a, const lcd_rect &b) {
+	if(b.x1 < a.x1) {
+		a.x1 = b.x1;
+	}
+	if(b.y1 < a.y1) {
+		a.y1 = b.y1;
+	}
+	if(b.x2 > a.x2) {
+		a.x2 = b.x2;
+	}
+	if(b.y2 > a.y2) {
+		a.y2 = b.y2;
+	}
+}
+
+static int32_t Rect_Area(const lcd_rect &a) {
+	return (int32_t)(a.x2 - a.x1 + 1) * (a.y2 - a.y1 + 1);
+}
+
+// the number of address window commands needed to go from window a to b
+static uint8_t Window_Changes(const lcd_rect &a, const lcd_rect &b) {
+	return ((a.x1 != b.x1) || (a.x2 != b.x2)) + ((a.y1 != b.y1) || (a.y2 != b.y2));
+}
+
+LCDWIKI_Damage::LCDWIKI_Damage(void) {
+	count = 0;
+}
+
+/*!
+ * @brief Add a rectangle that has changed.  Any rectangles that it overlaps
+ *   or shares an edge with are merged into it, and when the list is full it
+ *   is merged into the rectangle that grows the least.
+ *
+ * @param x1 The left column
+ * @param y1 The top row
+ * @param x2 The right column, inclusive
+ * @param y2 The bottom row, inclusive
+ */
+void LCDWIKI_Damage::Add(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	lcd_rect r = { x1, y1, x2, y2 };
+
+	if((x2 < x1) || (y2 < y1)) {
+		return;
+	}
+
+	for(;;) {
+		// a merged rectangle can reach ones that the original did not, so
+		// start again after every merge
+		uint8_t i = 0;
+		while(i < count) {
+			if(Rects_Touch(rects[i], r)) {
+				Rect_Union(r, rects[i]);
+				Remove(i);
+				i = 0;
+			} else {
+				i++;
+			}
+		}
+
+		if(count < DAMAGE_MAX_RECTS) {
+			break;
+		}
+
+		uint8_t best = 0;
+		int32_t best_growth = 0;
+		for(i = 0; i < count; i++) {
+			lcd_rect u = rects[i];
+			Rect_Union(u, r);
+
+			int32_t growth = Rect_Area(u) - Rect_Area(rects[i]);
+			if((i == 0) || (growth < best_growth)) {
+				best = i;
+				best_growth = growth;
+			}
+		}
+		Rect_Union(r, rects[best]);
+		Remove(best);
+	}
+
+	rects[count++] = r;
+}
+
+/*!
+ * @brief Forget all of the rectangles
+ */
+void LCDWIKI_Damage::Clear(void) {
+	count = 0;
+}
+
+/*!
+ * @brief Put the rectangles in the order that needs the fewest address window
+ *   commands to send them: starting from the top left one, each next one is
+ *   whichever shares the most of its columns and rows with the one before
+ *   (see the address window cache in LCDWIKI_SPI::Set_Addr_Window_DCS())
+ */
+void LCDWIKI_Damage::Sort(void) {
+	uint8_t i;
+	uint8_t j;
+
+	if(count < 2) {
+		return;
+	}
+
+	for(i = 0; i < count; i++) {
+		uint8_t best = i;
+
+		for(j = i + 1; j < count; j++) {
+			if(i == 0) {
+				if((rects[j].y1 < rects[best].y1) ||
+						((rects[j].y1 == rects[best].y1) && (rects[j].x1 < rects[best].x1))) {
+					best = j;
+				}
+			} else if(Window_Changes(rects[i - 1], rects[j]) < Window_Changes(rects[i - 1], rects[best])) {
+				best = j;
+			}
+		}
+
+		lcd_rect r = rects[i];
+		rects[i] = rects[best];
+		rects[best] = r;
+	}
+}
+
+uint8_t LCDWIKI_Damage::Get_Count(void) const {
+	return count;
+}
+
+/*!
+ * @brief Get one of the rectangles, 0 to Get_Count() - 1
+ */
+const lcd_rect &LCDWIKI_Damage::Get_Rect(uint8_t i) const {
+	return rects[i];
+}
+
+// take rectangle i out of the list, the order does not matter until Sort()
+void LCDWIKI_Damage::Remove(uint8_t i) {
+	rects[i] = rects[--count];
+}
@@ -0,0 +1,49 @@
+// Damage (dirty rectangle) tracking for the Lcdwiki GUI library
+// MIT license
+
+#ifndef _LCDWIKI_DAMAGE_H_
+#define _LCDWIKI_DAMAGE_H_
+
+#if ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+// The most rectangles that a damage list holds, once it is full each new
+// rectangle is merged into whichever one it grows the least
+#ifndef DAMAGE_MAX_RECTS
+	#define DAMAGE_MAX_RECTS 8
+#endif
+
+typedef struct _lcd_rect {
+	int16_t x1;
+	int16_t y1;
+	int16_t x2;
+	int16_t y2;
+} lcd_rect;
+
+/*!
+ * @brief A short list of the rectangles that have changed since it was last
+ *   cleared.  Rectangles that overlap or share an edge are merged as they are
+ *   added, so that each pixel is only sent once and the list stays small.
+ *   See LCDWIKI_SPI::Begin_Frame().
+ */
+class LCDWIKI_Damage {
+	public:
+		LCDWIKI_Damage(void);
+
+		void Add(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+		void Clear(void);
+		void Sort(void);
+		uint8_t Get_Count(void) const;
+		const lcd_rect &Get_Rect(uint8_t i) const;
+
+	private:
+		lcd_rect rects[DAMAGE_MAX_RECTS];
+		uint8_t count;
+
+		void Remove(uint8_t i);
+};
+
+#endif
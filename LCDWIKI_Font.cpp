@@ -0,0 +1,116 @@
+// Indexed bitmap fonts for the Lcdwiki SPI library
+// MIT license
+
+#include "LCDWIKI_Font.h"
+
+/*!
+ * @brief Create a font from the tables made by tools/make_font.py
+ *
+ * @param width The width of each glyph in pixels
+ * @param height The height of each glyph in pixels
+ * @param count The number of characters
+ * @param codes The characters, in ascending order, in PROGMEM
+ * @param bitmaps The glyphs of the characters, in PROGMEM
+ * @param bits The bits per pixel, 1, or 2 or 4 for an anti-aliased font
+ */
+LCDWIKI_Font::LCDWIKI_Font(uint8_t width, uint8_t height, uint16_t count, const uint16_t *codes, const uint8_t *bitmaps, uint8_t bits) {
+	this->width = width;
+	this->height = height;
+	this->bits = ((bits == 2) || (bits == 4)) ? bits : 1;
+	this->count = count;
+	this->codes = codes;
+	this->bitmaps = bitmaps;
+}
+
+/*!
+ * @brief Find the glyph of a character
+ *
+ * @param code The Unicode character
+ *
+ * @return The glyph, in PROGMEM, or NULL if the font does not have the 
+ *   character
+ */
+const uint8_t *LCDWIKI_Font::Find(uint16_t code) const {
+	uint16_t lo = 0;
+	uint16_t hi = count;
+
+	// the first index at or after code is in lo..hi
+	while(lo < hi) {
+		uint16_t mid = lo + (hi - lo) / 2;
+
+		if(pgm_read_word(codes + mid) < code) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	if((lo == count) || (pgm_read_word(codes + lo) != code)) {
+		return NULL;
+	}
+
+	return bitmaps + (uint32_t)lo * height * ((width * bits + 7) / 8);
+}
+
+uint8_t LCDWIKI_Font::Get_Width(void) const {
+	return width;
+}
+
+uint8_t LCDWIKI_Font::Get_Height(void) const {
+	return height;
+}
+
+uint16_t LCDWIKI_Font::Get_Count(void) const {
+	return count;
+}
+
+/*!
+ * @brief Get the bits per pixel, 1, or 2 or 4 for an anti-aliased font
+ */
+uint8_t LCDWIKI_Font::Get_Bits(void) const {
+	return bits;
+}
+
+/*!
+ * @brief Decode the next character of a UTF-8 string, and move past it
+ *
+ * @param str The string, moved on to the next character
+ *
+ * @return The Unicode character, 0 at the end of the string, or 0xFFFD for
+ *   a character outside of 16 bits or a broken sequence
+ */
+uint16_t LCDWIKI_Font::Next_Char(const char *&str) {
+	uint8_t c = *str;
+	uint8_t follow;
+	uint16_t code;
+
+	if(!c) {
+		return 0;
+	}
+	str++;
+
+	if(c < 0x80) {
+		return c;
+	} else if((c & 0xE0) == 0xC0) {
+		code = c & 0x1F;
+		follow = 1;
+	} else if((c & 0xF0) == 0xE0) {
+		code = c & 0x0F;
+		follow = 2;
+	} else {
+		// a 4 byte character, or not the start of one at all
+		while((*str & 0xC0) == 0x80) {
+			str++;
+		}
+		return 0xFFFD;
+	}
+
+	while(follow--) {
+		if((*str & 0xC0) != 0x80) {
+			return 0xFFFD;
+		}
+		code = (code << 6) | (*str++ & 0x3F);
+	}
+
+	return code;
+}
@@ -0,0 +1,59 @@
+// Indexed bitmap fonts for the Lcdwiki SPI library
+// MIT license
+
+#ifndef _LCDWIKI_FONT_H_
+#define _LCDWIKI_FONT_H_
+
+#if ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#ifdef __AVR__
+	#include <avr/pgmspace.h>
+#elif defined(ESP8266)
+	#include <pgmspace.h>
+#elif !defined(pgm_read_word)
+	#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+	#define pgm_read_word(addr) (*(const unsigned short *)(addr))
+#endif
+
+/*!
+ * @brief A fixed size font in PROGMEM, with a sorted index
+ *   of the characters that it has, so that finding a glyph is a binary 
+ *   search however big the font is (a GB2312 subset of thousands of 
+ *   characters takes a dozen or so reads).  Make the tables with 
+ *   tools/make_font.py, and draw with LCDWIKI_SPI::Draw_Font_String().
+ *
+ *   The index is count Unicode characters in ascending order, and the 
+ *   bitmaps are a glyph for each of them in the same order, height rows of
+ *   (width * bits + 7) / 8 bytes.  A 1 bit font is drawn with 
+ *   LCDWIKI_SPI::Draw_Glyph(), and a 2 or 4 bit font is anti-aliased, each
+ *   pixel being the coverage of the text from 0 to 3 or 15 (see 
+ *   LCDWIKI_SPI::Draw_Alpha_Glyph()).
+ *
+ * @warning On the AVR the tables must be in the first 64 KB of flash
+ */
+class LCDWIKI_Font {
+	public:
+		LCDWIKI_Font(uint8_t width, uint8_t height, uint16_t count, const uint16_t *codes, const uint8_t *bitmaps, uint8_t bits = 1);
+
+		const uint8_t *Find(uint16_t code) const;
+		uint8_t Get_Width(void) const;
+		uint8_t Get_Height(void) const;
+		uint16_t Get_Count(void) const;
+		uint8_t Get_Bits(void) const;
+
+		static uint16_t Next_Char(const char *&str);
+
+	protected:
+		uint8_t width;
+		uint8_t height;
+		uint8_t bits;
+		uint16_t count;
+		const uint16_t *codes;
+		const uint8_t *bitmaps;
+};
+
+#endif
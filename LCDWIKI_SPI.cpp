@@ -16,18 +16,51 @@
 	#define USE_HWSPI_ONLY
 #endif
 
-#include <SPI.h>
-#include "pins_arduino.h"
-#include "wiring_private.h"
 #include "LCDWIKI_SPI.h"
+#include "LCDWIKI_Canvas.h"
+#include "LCDWIKI_Damage.h"
+#include "LCDWIKI_Font.h"
+#if !defined(LCDWIKI_HOST)
+	#include <SPI.h>
+	#include "pins_arduino.h"
+	#include "wiring_private.h"
+#endif
 #include "lcd_spi_registers.h"
+#include "lcd_spi_image.h"
 #include "mcu_spi_magic.h"
 
 #define TFTLCD_DELAY16  0xFFFF
 #define TFTLCD_DELAY8   0x7F
 #define MAX_REG_NUM     24
 
-static uint8_t SH1106_buffer[1024] = {0};
+// the SH1106 RAM buffer, see Set_SH1106_Buffer()
+#if SH1106_STATIC_BUFFER
+static uint8_t SH1106_static_buffer[1024] = {0};
+static uint8_t *SH1106_buffer = SH1106_static_buffer;
+#else
+static uint8_t *SH1106_buffer = NULL;
+#endif
+// whether SH1106_buffer was allocated by init_1106()
+static boolean SH1106_allocated = false;
+
+// the first and last column of each page of SH1106_buffer that has changed 
+// since SH1106_Display() last sent it, the page is clean while first > last
+static uint8_t SH1106_dirty_first[8];
+static uint8_t SH1106_dirty_last[8];
+
+static void SH1106_Mark_Clean(void) {
+	for(uint8_t i = 0; i < 8; i++) {
+		SH1106_dirty_first[i] = 0xFF;
+		SH1106_dirty_last[i] = 0;
+	}
+}
+
+static void SH1106_Mark_All(uint8_t width) {
+	for(uint8_t i = 0; i < 8; i++) {
+		SH1106_dirty_first[i] = 0;
+		SH1106_dirty_last[i] = width - 1;
+	}
+}
 
 //The mode,width and heigth of supported LCD modules
 lcd_info current_lcd_info[] = { 
@@ -73,49 +106,7 @@ LCDWIKI_SPI::LCDWIKI_SPI(uint16_t model,int8_t cs, int8_t cd, int8_t miso, int8_
 	_led = led;
 	hw_spi = false; //software spi
 	MODEL = model;
-	spicsPort = portOutputRegister(digitalPinToPort(_cs));
-	spicsPinSet = digitalPinToBitMask(_cs);
-	spicsPinUnset = ~spicsPinSet;
-		
-	if(cd < 0) {
-		spicdPort = 0;
-		spicdPinSet = 0;
-		spicdPinUnset = 0;
-	} else {
-		spicdPort = portOutputRegister(digitalPinToPort(_cd));
-		spicdPinSet = digitalPinToBitMask(_cd);
-		spicdPinUnset = ~spicdPinSet;	
-	}
-
-	if(miso < 0) {
-		spimisoPort = 0;
-		spimisoPinSet = 0;
-		spimisoPinUnset = 0;
-	} else {
-		spimisoPort = portOutputRegister(digitalPinToPort(_miso));
-		spimisoPinSet = digitalPinToBitMask(_miso);
-		spimisoPinUnset = ~spimisoPinSet;
-	}
-
-	spimosiPort = portOutputRegister(digitalPinToPort(_mosi));
-	spimosiPinSet = digitalPinToBitMask(_mosi);
-	spimosiPinUnset = ~spimosiPinSet;
-
-	spiclkPort = portOutputRegister(digitalPinToPort(_clk));
-	spiclkPinSet = digitalPinToBitMask(_clk);
-	spiclkPinUnset = ~spiclkPinSet;
-
-	*spicsPort     |=  spicsPinSet; // Set all control bits to HIGH (idle)
-	*spicdPort     |=  spicdPinSet; // Signals are ACTIVE LOW
-	*spimisoPort   |=  spimisoPinSet;
-	*spimosiPort   |=  spimosiPinSet;
-	*spiclkPort    |=  spiclkPinSet;
-
-	pinMode(cs, OUTPUT); // Enable outputs
-	pinMode(cd, OUTPUT);
-	pinMode(miso, INPUT);
-	pinMode(mosi, OUTPUT);
-	pinMode(clk, OUTPUT);
+	bus.Begin(cs, cd, miso, mosi, clk, hw_spi);
 
 	if(reset >= 0)  {
 		digitalWrite(reset, HIGH);
@@ -130,6 +121,19 @@ LCDWIKI_SPI::LCDWIKI_SPI(uint16_t model,int8_t cs, int8_t cd, int8_t miso, int8_
 	xoffset = 0;
 	yoffset = 0;
 	rotation = 0;
+	spi_block_len = 0;
+	cs_active = false;
+	cd_data = true;
+	win_valid = false;
+	batch_depth = 0;
+	async_active = false;
+	async_len = 0;
+	async_callback = NULL;
+	async_arg = NULL;
+	frame_shadow = NULL;
+	frame_damage = NULL;
+	frame_inside = false;
+	alpha_bits = 0;
 
  	lcd_model = current_lcd_info[model].lcd_id;
 
@@ -168,49 +172,7 @@ LCDWIKI_SPI::LCDWIKI_SPI(int16_t wid, int16_t heg, int8_t cs, int8_t cd, int8_t
 	_led = led;
 	hw_spi = false; //software spi
 
-	spicsPort = portOutputRegister(digitalPinToPort(_cs));
-	spicsPinSet = digitalPinToBitMask(_cs);
-	spicsPinUnset = ~spicsPinSet;
-		
-	if(cd < 0) {
-		spicdPort = 0;
-		spicdPinSet = 0;
-		spicdPinUnset = 0;
-	} else {
-		spicdPort = portOutputRegister(digitalPinToPort(_cd));
-		spicdPinSet = digitalPinToBitMask(_cd);
-		spicdPinUnset = ~spicdPinSet;	
-	}
-
-	if(miso < 0) {
-		spimisoPort = 0;
-		spimisoPinSet = 0;
-		spimisoPinUnset = 0;
-	} else {
-		spimisoPort = portOutputRegister(digitalPinToPort(_miso));
-		spimisoPinSet = digitalPinToBitMask(_miso);
-		spimisoPinUnset = ~spimisoPinSet;
-	}
-	
-	spimosiPort = portOutputRegister(digitalPinToPort(_mosi));
-	spimosiPinSet = digitalPinToBitMask(_mosi);
-	spimosiPinUnset = ~spimosiPinSet;
-
-	spiclkPort = portOutputRegister(digitalPinToPort(_clk));
-	spiclkPinSet = digitalPinToBitMask(_clk);
-	spiclkPinUnset = ~spiclkPinSet;
-
-	*spicsPort     |=  spicsPinSet; // Set all control bits to HIGH (idle)
-	*spicdPort     |=  spicdPinSet; // Signals are ACTIVE LOW
-	*spimisoPort   |=  spimisoPinSet;
-	*spimosiPort   |=  spimosiPinSet;
-	*spiclkPort    |=  spiclkPinSet;
-
-	pinMode(cs, OUTPUT);	  // Enable outputs
-	pinMode(cd, OUTPUT);
-	pinMode(miso, INPUT);
-	pinMode(mosi, OUTPUT);
-	pinMode(clk, OUTPUT);
+	bus.Begin(cs, cd, miso, mosi, clk, hw_spi);
 
 	if(reset >= 0)  {
 		digitalWrite(reset, HIGH);
@@ -223,6 +185,19 @@ LCDWIKI_SPI::LCDWIKI_SPI(int16_t wid, int16_t heg, int8_t cs, int8_t cd, int8_t
 	xoffset = 0;
 	yoffset = 0;
 	rotation = 0;
+	spi_block_len = 0;
+	cs_active = false;
+	cd_data = true;
+	win_valid = false;
+	batch_depth = 0;
+	async_active = false;
+	async_len = 0;
+	async_callback = NULL;
+	async_arg = NULL;
+	frame_shadow = NULL;
+	frame_damage = NULL;
+	frame_inside = false;
+	alpha_bits = 0;
 	lcd_model = 0xFFFF;
 	setWriteDir();
 	WIDTH = wid;
@@ -254,40 +229,7 @@ LCDWIKI_SPI::LCDWIKI_SPI(uint16_t model, int8_t cs, int8_t cd, int8_t reset, int
 	_led = led;
 	hw_spi = true; //hardware spi
 	MODEL = model;
-#if defined(__AVR__)
-	spicsPort = portOutputRegister(digitalPinToPort(_cs));
-	spicsPinSet = digitalPinToBitMask(_cs);
-	spicsPinUnset = ~spicsPinSet;
-	if(cd < 0)
-	{
-		spicdPort = 0;
-		spicdPinSet = 0;
-		spicdPinUnset = 0;
-	}
-	else
-	{
-		spicdPort = portOutputRegister(digitalPinToPort(_cd));
-		spicdPinSet = digitalPinToBitMask(_cd);
-		spicdPinUnset = ~spicdPinSet;	
-	}
-	spimisoPort = 0;
-	spimisoPinSet = 0;
-	spimisoPinUnset = 0;
-	spimosiPort = 0;
-	spimosiPinSet = 0;
-	spimosiPinUnset = 0;
-	spiclkPort = 0;
-	spiclkPinSet = 0;
-	spiclkPinUnset = 0;
-	
-	*spicsPort     |=  spicsPinSet; // Set all control bits to HIGH (idle)
-	*spicdPort     |=  spicdPinSet; // Signals are ACTIVE LOW
-#elif defined(ARDUINO_ARCH_ESP8266)
-	digitalWrite(_cs, HIGH);
-	digitalWrite(_cd, HIGH);
-#endif
-	pinMode(cs, OUTPUT);	  // Enable outputs
-	pinMode(cd, OUTPUT);
+	bus.Begin(cs, cd, -1, -1, -1, hw_spi);
 
 	if(reset >= 0) {
 		digitalWrite(reset, HIGH);
@@ -298,14 +240,22 @@ LCDWIKI_SPI::LCDWIKI_SPI(uint16_t model, int8_t cs, int8_t cd, int8_t reset, int
 		pinMode(led, OUTPUT);
 	}
 
-	SPI.begin();
-	SPI.setClockDivider(SPI_CLOCK_DIV4); // 4 MHz (half speed)
-	SPI.setBitOrder(MSBFIRST);
-	SPI.setDataMode(SPI_MODE0);
-
 	xoffset = 0;
 	yoffset = 0;
 	rotation = 0;
+	spi_block_len = 0;
+	cs_active = false;
+	cd_data = true;
+	win_valid = false;
+	batch_depth = 0;
+	async_active = false;
+	async_len = 0;
+	async_callback = NULL;
+	async_arg = NULL;
+	frame_shadow = NULL;
+	frame_damage = NULL;
+	frame_inside = false;
+	alpha_bits = 0;
  	lcd_model = current_lcd_info[model].lcd_id;
 
 	WIDTH = current_lcd_info[model].lcd_wid;
@@ -338,39 +288,7 @@ LCDWIKI_SPI::LCDWIKI_SPI(int16_t wid, int16_t heg, int8_t cs, int8_t cd, int8_t
 	_reset = reset;
 	_led = led;
 	hw_spi = true; //hardware spi
-#if defined(__AVR__)
-	spicsPort = portOutputRegister(digitalPinToPort(_cs));
-	spicsPinSet = digitalPinToBitMask(_cs);
-	spicsPinUnset = ~spicsPinSet;
-	if(cd < 0) {
-		spicdPort = 0;
-		spicdPinSet = 0;
-		spicdPinUnset = 0;
-	} else {
-		spicdPort = portOutputRegister(digitalPinToPort(_cd));
-		spicdPinSet = digitalPinToBitMask(_cd);
-		spicdPinUnset = ~spicdPinSet;	
-	}
-
-	spimisoPort = 0;
-	spimisoPinSet = 0;
-	spimisoPinUnset = 0;
-	spimosiPort = 0;
-	spimosiPinSet = 0;
-	spimosiPinUnset = 0;
-	spiclkPort = 0;
-	spiclkPinSet = 0;
-	spiclkPinUnset = 0;
-
-	*spicsPort     |=  spicsPinSet; // Set all control bits to HIGH (idle)
-	*spicdPort     |=  spicdPinSet; // Signals are ACTIVE LOW
-#elif defined(ARDUINO_ARCH_ESP8266)
-	digitalWrite(_cs, HIGH);
-	digitalWrite(_cd, HIGH);
-#endif
-
-	pinMode(cs, OUTPUT);	  // Enable outputs
-	pinMode(cd, OUTPUT);	
+	bus.Begin(cs, cd, -1, -1, -1, hw_spi);
 
 	if(reset >= 0) {
 		digitalWrite(reset, HIGH);
@@ -382,14 +300,22 @@ LCDWIKI_SPI::LCDWIKI_SPI(int16_t wid, int16_t heg, int8_t cs, int8_t cd, int8_t
 		pinMode(led, OUTPUT);
 	}
 
-	SPI.begin();
-	SPI.setClockDivider(SPI_CLOCK_DIV4); // 4 MHz (half speed)
-	SPI.setBitOrder(MSBFIRST);
-	SPI.setDataMode(SPI_MODE0);
-
 	xoffset = 0;
 	yoffset = 0;
 	rotation = 0;
+	spi_block_len = 0;
+	cs_active = false;
+	cd_data = true;
+	win_valid = false;
+	batch_depth = 0;
+	async_active = false;
+	async_len = 0;
+	async_callback = NULL;
+	async_arg = NULL;
+	frame_shadow = NULL;
+	frame_damage = NULL;
+	frame_inside = false;
+	alpha_bits = 0;
  	lcd_model = 0xFFFF;
 	setWriteDir();
 	WIDTH = wid;
@@ -401,8 +327,11 @@ LCDWIKI_SPI::LCDWIKI_SPI(int16_t wid, int16_t heg, int8_t cs, int8_t cd, int8_t
 /*!
  * Initialise the LCD - which __MUST__ be called before anything is done - 
  * this resets the controller, turns on the LCD and then calls start()
+ *
+ * @param calibrate If true, pick the fastest SPI clocks that the display 
+ *   reads back correctly at, see Calibrate_Spi_Clock()
  */
-void LCDWIKI_SPI::Init_LCD(void) {
+void LCDWIKI_SPI::Init_LCD(boolean calibrate) {
 	reset();
 	Led_control(true);
 
@@ -411,6 +340,118 @@ void LCDWIKI_SPI::Init_LCD(void) {
 	}
 
 	start(lcd_model);
+
+	if(calibrate) {
+		Calibrate_Spi_Clock();
+	}
+}
+
+/*!
+ * @brief Set the hardware SPI clock rates, these have no effect on software 
+ *   SPI.  The board rounds them down to the nearest rate that it can do.
+ *
+ * @param write_hz The clock rate for writing to the display
+ * @param read_hz The clock rate for reading from the display (Read_Reg(),
+ *   Read_GRAM() and Read_ID())
+ */
+void LCDWIKI_SPI::Set_Spi_Clock(uint32_t write_hz, uint32_t read_hz) {
+	bus.Set_Clock(write_hz, read_hz);
+}
+
+uint32_t LCDWIKI_SPI::Get_Spi_Write_Clock(void) const {
+	return bus.Get_Write_Clock();
+}
+
+uint32_t LCDWIKI_SPI::Get_Spi_Read_Clock(void) const {
+	return bus.Get_Read_Clock();
+}
+
+// the clock rates that Calibrate_Spi_Clock() tries, fastest first.  The ones 
+// that are faster than the board can do all round down to its fastest.
+static const uint32_t spi_clock_steps[] = { 
+	80000000, 40000000, 27000000, 20000000, 16000000, 
+	10000000, 8000000, 4000000, 2000000, 1000000 
+};
+#define SPI_CLOCK_STEPS (sizeof(spi_clock_steps) / sizeof(spi_clock_steps[0]))
+
+/*!
+ * @brief Find the fastest hardware SPI clock rates that the display (and the
+ *   wiring to it) can take.  A test pattern is written to the first 8 pixels 
+ *   of the top row at the slowest rate and read back through Read_GRAM() at 
+ *   each rate in turn, fastest first, to pick the read clock.  Then the 
+ *   pattern is written at each rate in turn and read back at that read clock
+ *   to pick the write clock.  The pixels are put back as they were afterwards.
+ *
+ * @return false if the display could not be read back at any rate (MISO is 
+ *   often not wired up), or this is software SPI, and the clocks are left 
+ *   as they were
+ *
+ * @warning When the display cannot be read back, what was saved of the 8 
+ *   pixels is whatever the read returned (often all black or all white), 
+ *   and that is what they are left as
+ */
+boolean LCDWIKI_SPI::Calibrate_Spi_Clock(void) {
+	static const uint16_t pattern[8] = { 0xF800, 0x07E0, 0x001F, 0xA5A5, 0x5A5A, 0xFFFF, 0x0000, 0x1234 };
+	uint16_t saved[8];
+	uint16_t expect[8];
+	uint16_t check[8];
+	uint32_t slowest = spi_clock_steps[SPI_CLOCK_STEPS - 1];
+	uint32_t write_hz = Get_Spi_Write_Clock();
+	uint32_t read_hz = Get_Spi_Read_Clock();
+	uint8_t i;
+
+	if(!hw_spi || (lcd_driver == ID_1106) || (lcd_driver == ID_UNKNOWN)) {
+		return false;
+	}
+
+	Set_Spi_Clock(slowest, slowest);
+	Read_GRAM(0, 0, saved, 8, 1);
+
+	memcpy(expect, pattern, sizeof(pattern));
+	Set_Addr_Window(0, 0, 7, 0);
+	Push_Any_Color(expect, 8, true, 0);
+
+	for(i = 0; i < SPI_CLOCK_STEPS; i++) {
+		Set_Spi_Clock(slowest, spi_clock_steps[i]);
+		Read_GRAM(0, 0, check, 8, 1);
+		if(!memcmp(check, expect, sizeof(expect))) {
+			break;
+		}
+	}
+
+	if(i == SPI_CLOCK_STEPS) {
+		// not even the slowest read matched, so what was saved cannot be 
+		// trusted either, but it is better than leaving the pattern up
+		Set_Spi_Clock(slowest, slowest);
+		Set_Addr_Window(0, 0, 7, 0);
+		Push_Any_Color(saved, 8, true, 0);
+		Set_Spi_Clock(write_hz, read_hz);
+		return false;
+	}
+	read_hz = spi_clock_steps[i];
+
+	for(i = 0; i < SPI_CLOCK_STEPS; i++) {
+		// invert the pattern every time, so that what the last step left 
+		// behind can never pass for this one
+		for(uint8_t j = 0; j < 8; j++) {
+			expect[j] = ~expect[j];
+		}
+
+		Set_Spi_Clock(spi_clock_steps[i], read_hz);
+		Set_Addr_Window(0, 0, 7, 0);
+		Push_Any_Color(expect, 8, true, 0);
+		Read_GRAM(0, 0, check, 8, 1);
+		if(!memcmp(check, expect, sizeof(expect))) {
+			break;
+		}
+	}
+
+	write_hz = (i < SPI_CLOCK_STEPS) ? spi_clock_steps[i] : slowest;
+	Set_Spi_Clock(write_hz, read_hz);
+
+	Set_Addr_Window(0, 0, 7, 0);
+	Push_Any_Color(saved, 8, true, 0);
+	return true;
 }
 
 /*!
@@ -420,6 +461,8 @@ void LCDWIKI_SPI::Init_LCD(void) {
  * @param void
  */
 void LCDWIKI_SPI::reset(void) {
+	batch_depth = 0;
+	Invalidate_Addr_Window();
 	CS_IDLE;
 	RD_IDLE;
 	WR_IDLE;
@@ -457,50 +500,212 @@ void LCDWIKI_SPI::Led_control(boolean turnOn) {
 	}
 }
 
+/*!
+ * @brief Keep the chip selected until the matching End_Batch(), so that a 
+ *   run of drawing calls does not toggle CS around every one of them.  
+ *   Batches may be nested, the chip is released by the outermost End_Batch().
+ *
+ * @warning reset() (and so Init_LCD() and start()) ends any batch
+ */
+void LCDWIKI_SPI::Begin_Batch(void) {
+	CS_ACTIVE;
+	batch_depth++;
+}
+
+/*!
+ * @brief End a batch started with Begin_Batch(), releasing the chip if this 
+ *   is the outermost batch.  An async push that is still running is finished
+ *   first.
+ */
+void LCDWIKI_SPI::End_Batch(void) {
+	Wait_Async();
+
+	if(batch_depth && !--batch_depth) {
+		CS_IDLE;
+	}
+}
+
 //spi write for hardware and software
 void LCDWIKI_SPI::Spi_Write(uint8_t data) {
-	if(hw_spi) {
-		SPI.transfer(data);
-	} else {
-		uint8_t val = 0x80;
-		while(val) {
-			if(data&val) {
-				MOSI_HIGH; 
-			} else {
-				MOSI_LOW;
-			}
-			CLK_LOW;
-			CLK_HIGH;
-			val >>= 1;
-		}
-	}
+	bus.Write8(data);
 }
 
 //spi read for hardware and software
 uint8_t LCDWIKI_SPI::Spi_Read(void) {
-	if(hw_spi) {
-		return SPI.transfer(0xFF);
+	return bus.Read8();
+}
+
+/*!
+ * @brief Write a block of bytes to the display in one go.  For hardware SPI
+ *   this will keep the SPI peripheral busy back to back, rather than paying
+ *   for the call and wait overhead of Spi_Write() on every byte.
+ *
+ * @param block The pointer to the bytes to write
+ * @param n The number of bytes to write
+ *
+ * @warning CS and CD are not touched - set them up before calling this
+ */
+void LCDWIKI_SPI::Spi_Write_Block(const uint8_t *block, size_t n) {
+	bus.Write_Block(block, n);
+}
+
+/*!
+ * @brief Get the transport that drives the bus lines, with the recording
+ *   transport this is where the byte counts and the event log are read from.
+ *
+ * @return The transport
+ *
+ * @warning The driver remembers the levels it left CS and CD at, so do not 
+ *   drive those lines through the transport directly
+ */
+LCDWIKI_Transport &LCDWIKI_SPI::Get_Transport(void) {
+	return bus;
+}
+
+// The 5 bit red and blue of rgb565 as the top 6 bits of an rgb666 byte, with
+// the top bit copied into the bottom so that 0x1F becomes 0x3F (full 
+// brightness) rather than 0x3E.  Green is already 6 bits.
+static const uint8_t rgb5_to_6[32] PROGMEM = {
+	0x00, 0x08, 0x10, 0x18, 0x20, 0x28, 0x30, 0x38,
+	0x40, 0x48, 0x50, 0x58, 0x60, 0x68, 0x70, 0x78,
+	0x84, 0x8C, 0x94, 0x9C, 0xA4, 0xAC, 0xB4, 0xBC,
+	0xC4, 0xCC, 0xD4, 0xDC, 0xE4, 0xEC, 0xF4, 0xFC
+};
+
+/*!
+ * @brief Encode one rgb565 colour in the pixel format that the display 
+ *   expects, 2 bytes for rgb565 or 3 bytes for rgb666 (ILI9488_18)
+ *
+ * @param color The rgb565 colour to encode
+ * @param dst Where to write the PIXEL_BYTES bytes
+ */
+template<uint8_t PIXEL_BYTES>
+static inline void Encode_Color(uint16_t color, uint8_t *dst) {
+	if(PIXEL_BYTES == 3) {
+		dst[0] = pgm_read_byte(&rgb5_to_6[color >> 11]);
+		dst[1] = (color>>3)&0xFC;
+		dst[2] = pgm_read_byte(&rgb5_to_6[color & 0x1F]);
 	} else {
+		dst[0] = color>>8;
+		dst[1] = color;
+	}
+}
 
-		uint8_t val,
-				i,
-				d;
+/*!
+ * @brief Encode a run of rgb565 colours from RAM, back to back, in the pixel
+ *   format that the display expects
+ *
+ * @param src The rgb565 colours
+ * @param dst Where to write the n * PIXEL_BYTES bytes
+ * @param n The number of colours
+ */
+template<uint8_t PIXEL_BYTES>
+static inline void Encode_Block(const uint16_t *src, uint8_t *dst, uint16_t n) {
+	while(n--) {
+		Encode_Color<PIXEL_BYTES>(*src++, dst);
+		dst += PIXEL_BYTES;
+	}
+}
 
-		for(i = 0;i<8; i++) {
-			CLK_LOW; 
-			CLK_HIGH;
-			val <<= 1;
-			MISO_STATE(d);
+/*!
+ * @brief Start writing pixels to the display memory, at the top left of the
+ *   address window if first is set, or to the shadow canvas when 
+ *   PIXEL_BYTES is 0
+ */
+template<uint8_t PIXEL_BYTES>
+inline void LCDWIKI_SPI::Begin_Pixels(bool first) {
+	if(!PIXEL_BYTES) {
+		if(first) {
+			frame_shadow->Restart_Window();
+		}
+		return;
+	}
 
-			if(d) {
-				val |= 0x01;
-			}
+	CS_ACTIVE;
+	if (first) {
+		if(lcd_driver == ID_932X) {
+			writeCmd8(ILI932X_START_OSC);
+		}
+		writeCmd8(CC);
+	}
+	CD_DATA;
+}
+
+/*!
+ * @brief Finish writing the pixels started by Begin_Pixels()
+ */
+template<uint8_t PIXEL_BYTES>
+inline void LCDWIKI_SPI::End_Pixels(void) {
+	if(!PIXEL_BYTES) {
+		frame_shadow->Commit_Damage();
+		return;
+	}
+
+	Flush_Block();
+	CS_IDLE;
+}
+
+/*!
+ * @brief Add one rgb565 colour to the staging buffer in the pixel format that
+ *   the display expects, sending the buffer when it is full.
+ *
+ * @param color The rgb565 colour to stage
+ *
+ * @warning CD must already be set to data, as a full buffer is sent straight away
+ */
+template<uint8_t PIXEL_BYTES>
+inline void LCDWIKI_SPI::Stage_Color(uint16_t color) {
+	if(!PIXEL_BYTES) {
+		frame_shadow->Write_Next(color);
+		return;
+	}
+
+	Encode_Color<PIXEL_BYTES>(color, spi_block + spi_block_len);
+	spi_block_len += PIXEL_BYTES;
+
+	if(spi_block_len > SPI_BLOCK_SIZE - PIXEL_BYTES) {
+		Flush_Block();
+	}
+}
+
+/*!
+ * @brief Send whatever is left in the staging buffer to the display
+ */
+void LCDWIKI_SPI::Flush_Block(void) {
+	if(spi_block_len) {
+		Spi_Write_Block(spi_block, spi_block_len);
+		spi_block_len = 0;
+	}
+}
+
+/*!
+ * @brief Send the same colour n times.  The colour is encoded once and the 
+ *   transport repeats it, see Write_Pattern() in lcd_spi_transport.h.
+ *
+ * @param color The rgb565 colour to send
+ * @param n The number of pixels to send
+ *
+ * @warning CD must already be set to data
+ */
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Push_Color_Repeat(uint16_t color, uint32_t n) {
+	uint8_t pixel[3];
+
+	if(!PIXEL_BYTES) {
+		while(n--) {
+			frame_shadow->Write_Next(color);
 		}
-		return val;
+		return;
 	}
+
+	Flush_Block();
+
+	Encode_Color<PIXEL_BYTES>(color, pixel);
+	bus.Write_Pattern(pixel, PIXEL_BYTES, n);
 }
 
 void LCDWIKI_SPI::Write_Cmd(uint16_t cmd) {
+	Invalidate_Addr_Window();
 	CS_ACTIVE;
 	writeCmd16(cmd);
 	CS_IDLE;
@@ -513,6 +718,7 @@ void LCDWIKI_SPI::Write_Data(uint16_t data) {
 }
 
 void LCDWIKI_SPI::Write_Cmd_Data(uint16_t cmd, uint16_t data) {
+	Invalidate_Addr_Window();
 	CS_ACTIVE;
 	writeCmdData16(cmd,data);
 	CS_IDLE;
@@ -520,6 +726,8 @@ void LCDWIKI_SPI::Write_Cmd_Data(uint16_t cmd, uint16_t data) {
 
 //Write a command and N datas
 void LCDWIKI_SPI::Push_Command(uint8_t cmd, uint8_t *block, int8_t N) {
+	// the command may well move the address window
+	Invalidate_Addr_Window();
 	CS_ACTIVE;
 
 	if(lcd_driver == ID_1106) {
@@ -543,6 +751,21 @@ void LCDWIKI_SPI::Push_Command(uint8_t cmd, uint8_t *block, int8_t N) {
 
 
 void LCDWIKI_SPI::Set_Addr_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	if(frame_shadow && Frame_Window(x1, y1, x2, y2)) {
+		// all on the frame's shadow canvas, nothing goes to the display
+		return;
+	}
+
+	if(lcd_driver == ID_1106) {
+		return;
+	}
+
+	if((lcd_driver != ID_932X) && (lcd_driver != ID_9225) && (lcd_driver != ID_7575) && (lcd_driver != ID_1283A)) {
+		// this selects the chip itself, and only if there is anything to send
+		Set_Addr_Window_DCS(x1, y1, x2, y2);
+		return;
+	}
+
 	CS_ACTIVE;
 
 	if((lcd_driver == ID_932X) || (lcd_driver == ID_9225)) {
@@ -642,24 +865,71 @@ void LCDWIKI_SPI::Set_Addr_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2
 		writeData8(x1);
 		writeData8(y1);
 		writeCmd8(CC);
-	} else if(lcd_driver == ID_1106) {
+	}
+
+	CS_IDLE;
+}
+
+/*!
+ * @brief Set the address window on the controllers that use the MIPI DCS 
+ *   column (XC) and page (YC) address set commands, which is all of them 
+ *   apart from the 932X, 9225, 7575, 1283A and 1106.
+ *
+ * @param x1 The left column of the window
+ * @param y1 The top row of the window
+ * @param x2 The right column of the window
+ * @param y2 The bottom row of the window
+ *
+ * @note xoffset and yoffset are only ever set for the ST7735S128, they are 0
+ *   for everything else
+ */
+void LCDWIKI_SPI::Set_Addr_Window_DCS(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	x1 += xoffset;
+	x2 += xoffset;
+	y1 += yoffset;
+	y2 += yoffset;
+
+	// the memory write command starts again from the top left of the window,
+	// so an axis that has not changed does not need to be sent again
+	boolean send_x = !win_valid || (x1 != win_x1) || (x2 != win_x2);
+	boolean send_y = !win_valid || (y1 != win_y1) || (y2 != win_y2);
+
+	if(!send_x && !send_y) {
 		return;
-	} else if(lcd_driver == ID_7735_128) {
-		uint8_t x_buf[] = {(x1+xoffset)>>8,(x1+xoffset)&0xFF,(x2+xoffset)>>8,(x2+xoffset)&0xFF};
-		uint8_t y_buf[] = {(y1+yoffset)>>8,(y1+yoffset)&0xFF,(y2+yoffset)>>8,(y2+yoffset)&0xFF};
-		Push_Command(XC, x_buf, 4);
-		Push_Command(YC, y_buf, 4);
-	} else {
-		uint8_t x_buf[] = { x1>>8, x1&0xFF, x2>>8, x2&0xFF };
-		uint8_t y_buf[] = { y1>>8, y1&0xFF, y2>>8, y2&0xFF };
-	
-		Push_Command(XC, x_buf, 4);
-		Push_Command(YC, y_buf, 4);
 	}
 
+	CS_ACTIVE;
+	if(send_x) {
+		uint8_t x_buf[] = { (uint8_t)(x1 >> 8), (uint8_t)x1, (uint8_t)(x2 >> 8), (uint8_t)x2 };
+
+		writeCmd16(XC);
+		CD_DATA;
+		Spi_Write_Block(x_buf, 4);
+		win_x1 = x1;
+		win_x2 = x2;
+	}
+	if(send_y) {
+		uint8_t y_buf[] = { (uint8_t)(y1 >> 8), (uint8_t)y1, (uint8_t)(y2 >> 8), (uint8_t)y2 };
+
+		writeCmd16(YC);
+		CD_DATA;
+		Spi_Write_Block(y_buf, 4);
+		win_y1 = y1;
+		win_y2 = y2;
+	}
+	win_valid = true;
 	CS_IDLE;
 }
 
+/*!
+ * @brief Forget the address window that was last sent, so that the next 
+ *   Set_Addr_Window() sends both the columns and the pages.  Call this after
+ *   sending commands to the display straight through Spi_Write().
+ */
+void LCDWIKI_SPI::Invalidate_Addr_Window(void) {
+	win_valid = false;
+}
+
 // Unlike the 932X drivers that set the address window to the full screen
 // by default (using the address counter for drawPixel operations), the
 // 7575 needs the address window set on all graphics operations.  In order
@@ -691,6 +961,25 @@ void LCDWIKI_SPI::Set_LR(void) {
  *   undefined
  */
 void LCDWIKI_SPI::Push_Compressed_Image(int16_t x, int16_t y, uint16_t *block, uint8_t flags) {
+	if(MODEL == ILI9488_18) {
+		Push_Compressed_Image_T<3>(x, y, block, flags);
+	} else {
+		Push_Compressed_Image_T<2>(x, y, block, flags);
+	}
+}
+
+// Push_Compressed_Image() for one pixel format, PIXEL_BYTES is 2 for rgb565 or 3 for rgb666
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Push_Compressed_Image_T(int16_t x, int16_t y, uint16_t *block, uint8_t flags) {
+	if(PIXEL_BYTES && frame_shadow) {
+		// into the frame's shadow canvas, and straight to the display as 
+		// well where it is not all on the shadow
+		Push_Compressed_Image_T<0>(x, y, block, flags);
+		if(frame_inside) {
+			return;
+		}
+	}
+
 	uint16_t color;
 	uint16_t numberToDraw;
 
@@ -709,19 +998,13 @@ void LCDWIKI_SPI::Push_Compressed_Image(int16_t x, int16_t y, uint16_t *block, u
 		height = (*block++);
 	}
 
-  int16_t numPixels = width * height;
+	long numPixels = (long)width * height;
 
 	Set_Addr_Window(x, y, x + width - 1, y + height - 1);
 
-	CS_ACTIVE;
-
-	if(lcd_driver == ID_932X) {
-		writeCmd8(ILI932X_START_OSC);
-	}
-
-	writeCmd8(CC);
+	Begin_Pixels<PIXEL_BYTES>(true);
 
-	while(numPixels-- > 0) {
+	while(numPixels > 0) {
 		if(isconst) {
 			numberToDraw = pgm_read_word(block++);
 		} else {
@@ -739,13 +1022,7 @@ void LCDWIKI_SPI::Push_Compressed_Image(int16_t x, int16_t y, uint16_t *block, u
 				color = (*block++);
 			}
 			
-			while(numberToDraw-- > 0) {
-				if(MODEL == ILI9488_18) {
-					writeData18(color);
-				} else {
-					writeData16(color);
-				}
-			}
+			Push_Color_Repeat<PIXEL_BYTES>(color, numberToDraw);
 		} else {
 			// draw the raw colors
 			numPixels -= numberToDraw;
@@ -756,15 +1033,11 @@ void LCDWIKI_SPI::Push_Compressed_Image(int16_t x, int16_t y, uint16_t *block, u
 					color = (*block++);
 				}
 
-				if(MODEL == ILI9488_18) {
-					writeData18(color);
-				} else {
-					writeData16(color);
-				}
+				Stage_Color<PIXEL_BYTES>(color);
 			}
 		}
 	}
-	CS_IDLE;
+	End_Pixels<PIXEL_BYTES>();
 }
 
 /*!
@@ -783,88 +1056,152 @@ void LCDWIKI_SPI::Push_Compressed_Image(int16_t x, int16_t y, uint16_t *block, u
  *   undefined
  */
 void LCDWIKI_SPI::Push_Indexed_Image(int16_t x, int16_t y, uint8_t *block, uint8_t flags) {
-	uint16_t color; // the current colour that we are drawing
-	uint16_t width; // the width of the image
-	uint16_t height; // the height of the image
-	long numPixels; // the number of pixels we have - which is width * height
+	if(MODEL == ILI9488_18) {
+		Push_Indexed_Image_T<3>(x, y, block, flags);
+	} else {
+		Push_Indexed_Image_T<2>(x, y, block, flags);
+	}
+}
 
-	uint8_t numberToDraw; // the number of compressed colours to draw
-	uint8_t h; // reading the high byte for 2 bytes of width
-	uint8_t l; // reading the low byte for 2 bytes of height
+/*!
+ * @brief Push an indexed image (see above), and build the index map that 
+ *   Set_Palette_Entry() uses to recolour it: the bounds of each colour map
+ *   index in the image, and optionally the rows that each one is used on.
+ *
+ * @param x The x or top co-ordinate to start drawing at (top-left)
+ * @param y The y or left co-ordinate to start drawing at (top-left)
+ * @param block The pointer to the block of data
+ * @param flags If set to 1 - it will read from PROGMEM address, else it will 
+ *   just read from memory
+ * @param bounds One rectangle for each entry of the colour map, in image 
+ *   co-ordinates (x1 > x2 for an index that is not used)
+ * @param rows (height + 7) / 8 bytes for each entry of the colour map, a bit
+ *   for each row, or NULL to only keep the bounds
+ */
+void LCDWIKI_SPI::Push_Indexed_Image(int16_t x, int16_t y, uint8_t *block, uint8_t flags, lcd_rect *bounds, uint8_t *rows) {
+	if(bounds) {
+		Map_Indexed_Image(block, flags, bounds, rows);
+	}
+	Push_Indexed_Image(x, y, block, flags);
+}
 
-	uint8_t colorIndex; // the index of the colour that maps to the colour index in the header
-	uint8_t numEntries; // the number of colour map entries in the header
-	uint8_t mapPointer; // the pointer to the start of the colour map
+// Build the index map of an indexed image, a run at a time
+void LCDWIKI_SPI::Map_Indexed_Image(const uint8_t *block, uint8_t flags, lcd_rect *bounds, uint8_t *rows) {
+	bool isconst = flags & 1;
+	uint16_t w;
+	uint16_t h;
+	uint8_t numEntries;
+
+	lcd_read_indexed_header(block, flags, w, h, numEntries);
+
+	int16_t stride = (h + 7) / 8;
+	for(uint16_t i = 0; i < numEntries; i++) {
+		bounds[i].x1 = w;
+		bounds[i].y1 = h;
+		bounds[i].x2 = -1;
+		bounds[i].y2 = -1;
+	}
+	if(rows) {
+		memset(rows, 0, numEntries * stride);
+	}
+	if((w == 0) || (h == 0)) {
+		return;
+	}
 
-	bool isconst = flags & 1; // whether to read from PROGMEM, or memory
-	bool is8Bit = false; // Whether to use 8 or 16 bit widths
+	#define NEXT_BYTE() (isconst ? pgm_read_byte(block++) : *block++)
 
-	uint8_t *mapAddress = block; // 
+	uint16_t col = 0;
+	uint16_t row = 0;
+	uint8_t colorIndex = 0;
 
-	if(isconst) {
-		is8Bit = pgm_read_byte(block++); 
-		mapAddress += 1;
+	while(row < h) {
+		uint8_t numberToDraw = NEXT_BYTE();
 
-		if(is8Bit) {
-			width = pgm_read_byte(block++);
-			height = pgm_read_byte(block++);
-			mapAddress += 2;
-		} else {
-			width = pgm_read_word(block++);
-			height = pgm_read_word(block++);
-			mapAddress += 4;
+		bool repeat = numberToDraw & 0x80;
+		numberToDraw &= 0x7F;
+		if(repeat) {
+			colorIndex = NEXT_BYTE();
 		}
 
-		// here we have the height and width - the next byte is the number
-		// of entries in the map
-
-		numEntries = pgm_read_byte(block++);
-		mapAddress += 1;
-	} else {
-		is8Bit = (*block++);
+		while(numberToDraw > 0) {
+			if(!repeat) {
+				colorIndex = NEXT_BYTE();
+			}
 
-		if(is8Bit) {
-			width = (*block++);
-			height = (*block++);
-		} else {
-			h = (*block++);
-			l = (*block++);
-			width = (h << 8 | l);
+			// a repeat run is marked a row at a time
+			uint8_t n = repeat ? ((numberToDraw < w - col) ? numberToDraw : w - col) : 1;
+			if(colorIndex < numEntries) {
+				lcd_rect &r = bounds[colorIndex];
+				if((int16_t)col < r.x1) {
+					r.x1 = col;
+				}
+				if((int16_t)(col + n - 1) > r.x2) {
+					r.x2 = col + n - 1;
+				}
+				if((int16_t)row < r.y1) {
+					r.y1 = row;
+				}
+				r.y2 = row;
+				if(rows) {
+					rows[colorIndex * stride + row / 8] |= 1 << (row & 7);
+				}
+			}
 
-			h = (*block++);
-			l = (*block++);
-			height = (h << 8 | l);
+			numberToDraw -= n;
+			col += n;
+			if(col == w) {
+				col = 0;
+				if(++row == h) {
+					break;
+				}
+			}
 		}
+	}
 
-		// here we have the height and width - the next byte is the number
-		// of entries in the map
+	#undef NEXT_BYTE
+}
 
-		numEntries = (*block++);
-		mapAddress += 1;
+// Push_Indexed_Image() for one pixel format, PIXEL_BYTES is 2 for rgb565 or 3 for rgb666
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Push_Indexed_Image_T(int16_t x, int16_t y, uint8_t *block, uint8_t flags) {
+	if(PIXEL_BYTES && frame_shadow) {
+		// into the frame's shadow canvas, and straight to the display as 
+		// well where it is not all on the shadow
+		Push_Indexed_Image_T<0>(x, y, block, flags);
+		if(frame_inside) {
+			return;
+		}
 	}
 
-	numPixels = width * height;
-	// now we need to skip ahead the number of entries
-	block += (numEntries * 2);
+	uint16_t color; // the current colour that we are drawing
+	uint16_t width; // the width of the image
+	uint16_t height; // the height of the image
+	long numPixels; // the number of pixels we have - which is width * height
+
+	uint8_t numberToDraw; // the number of compressed colours to draw
+	uint8_t colorIndex; // the index of the colour that maps to the colour index in the header
+	uint8_t numEntries; // the number of colour map entries in the header
+
+	bool isconst = flags & 1; // whether to read from PROGMEM, or memory
+
+	// the header, read the same way by everything that takes the format
+	const uint8_t *data = block;
+	const uint8_t *mapAddress = lcd_read_indexed_header(data, flags, width, height, numEntries);
+
+	numPixels = (long)width * height;
 
 	// At this point we are at the start of the data
 
 	// TODO - should we do bounds checking??
 	Set_Addr_Window(x, y, x + width - 1, y + height - 1);
 
-	CS_ACTIVE;
-
-	if(lcd_driver == ID_932X) {
-		writeCmd8(ILI932X_START_OSC);
-	}
-
-	writeCmd8(CC);
+	Begin_Pixels<PIXEL_BYTES>(true);
 
 	while(numPixels > 0) {
 		if(isconst) {
-			numberToDraw = pgm_read_byte(block++);
+			numberToDraw = pgm_read_byte(data++);
 		} else {
-			numberToDraw = (*block++);
+			numberToDraw = (*data++);
 		}
 
 		if ((numberToDraw & 0x80) == 0x80) {
@@ -873,20 +1210,14 @@ void LCDWIKI_SPI::Push_Indexed_Image(int16_t x, int16_t y, uint8_t *block, uint8
 			numPixels -= numberToDraw;
 
 			if(isconst) {
-				colorIndex = pgm_read_byte(block++);
+				colorIndex = pgm_read_byte(data++);
 				color = ((pgm_read_byte(mapAddress + (colorIndex * 2))) << 8) + (pgm_read_byte(mapAddress + (colorIndex * 2) + 1));
 			} else {
-				colorIndex = (*block++);
+				colorIndex = (*data++);
 				color = (*(mapAddress + (colorIndex * 2)) << 8) + *(mapAddress + (colorIndex * 2) + 1);
 			}
 			
-			while(numberToDraw-- > 0) {
-				if(MODEL == ILI9488_18) {
-					writeData18(color);
-				} else {
-					writeData16(color);
-				}
-			}
+			Push_Color_Repeat<PIXEL_BYTES>(color, numberToDraw);
 		} else {
 			// draw the raw colors
 			numPixels -= numberToDraw;
@@ -894,52 +1225,69 @@ void LCDWIKI_SPI::Push_Indexed_Image(int16_t x, int16_t y, uint8_t *block, uint8
 			while(numberToDraw-- > 0) {
 
 				if(isconst) {
-					colorIndex = pgm_read_byte(block++);
+					colorIndex = pgm_read_byte(data++);
 					color = ((pgm_read_byte(mapAddress + (colorIndex * 2))) << 8) + (pgm_read_byte(mapAddress + (colorIndex * 2) + 1));
 				} else {
-					colorIndex = (*block++);
+					colorIndex = (*data++);
 					color = (*(mapAddress + (colorIndex * 2)) << 8) + *(mapAddress + (colorIndex * 2) + 1);
 				}
 
-				if(MODEL == ILI9488_18) {
-					writeData18(color);
-				} else {
-					writeData16(color);
-				}
+				Stage_Color<PIXEL_BYTES>(color);
 			}
 		}
 	}
-	CS_IDLE;
+	End_Pixels<PIXEL_BYTES>();
 }
 
 //push color table for 16bits
 void LCDWIKI_SPI::Push_Any_Color(uint16_t * block, int16_t n, bool first, uint8_t flags) {
+	if(MODEL == ILI9488_18) {
+		Push_Any_Color_T<3>(block, n, first, flags);
+	} else {
+		Push_Any_Color_T<2>(block, n, first, flags);
+	}
+}
+
+// Push_Any_Color() for one pixel format, PIXEL_BYTES is 2 for rgb565 or 3 for rgb666
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Push_Any_Color_T(uint16_t * block, int16_t n, bool first, uint8_t flags) {
 	uint16_t color;
 	uint8_t h, l;
 	bool isconst = flags & 1;
 
-	CS_ACTIVE;
-	if (first) {  
-		if(lcd_driver == ID_932X) {
-			writeCmd8(ILI932X_START_OSC);
+	if(frame_shadow) {
+		// into the frame's shadow canvas, and straight to the display as 
+		// well where the window is not all on the shadow
+		frame_shadow->Push_Any_Color(block, n, first, flags);
+		if(frame_inside) {
+			return;
 		}
-		writeCmd8(CC);
 	}
 
-	while (n-- > 0) {
-		if (isconst) {
-			color = pgm_read_word(block++);		
-		} else  {
-			color = (*block++);
-		}
+	Begin_Pixels<PIXEL_BYTES>(first);
 
-		if(MODEL == ILI9488_18) {
-			writeData18(color);
-		} else {
-			writeData16(color);
+	if (!isconst) {
+		// straight from RAM, a staging buffer's worth at a time
+		while (n > 0) {
+			int16_t pixels = SPI_BLOCK_SIZE / PIXEL_BYTES;
+			if(pixels > n) {
+				pixels = n;
+			}
+
+			Encode_Block<PIXEL_BYTES>(block, spi_block, pixels);
+			Spi_Write_Block(spi_block, pixels * PIXEL_BYTES);
+			block += pixels;
+			n -= pixels;
 		}
+		CS_IDLE;
+		return;
 	}
-	CS_IDLE;
+
+	while (n-- > 0) {
+		color = pgm_read_word(block++);
+		Stage_Color<PIXEL_BYTES>(color);
+	}
+	End_Pixels<PIXEL_BYTES>();
 }
 
 
@@ -962,19 +1310,32 @@ void LCDWIKI_SPI::Push_Any_Color(uint16_t * block, int16_t n, bool first, uint8_
  *       3 - PROGMEM read and big-endian
  */
 void LCDWIKI_SPI::Push_Any_Color(uint8_t * block, int16_t n, bool first, uint8_t flags) {
+	if(MODEL == ILI9488_18) {
+		Push_Any_Color_T<3>(block, n, first, flags);
+	} else {
+		Push_Any_Color_T<2>(block, n, first, flags);
+	}
+}
+
+// Push_Any_Color() for one pixel format, PIXEL_BYTES is 2 for rgb565 or 3 for rgb666
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Push_Any_Color_T(uint8_t * block, int16_t n, bool first, uint8_t flags) {
 	uint16_t color;
 	uint8_t h, l;
 	bool isconst = flags & 1;
 	bool isbigend = (flags & 2) != 0;
-	CS_ACTIVE;
 
-	if (first) { 
-		if(lcd_driver == ID_932X) {
-			writeCmd8(ILI932X_START_OSC);
+	if(PIXEL_BYTES && frame_shadow) {
+		// into the frame's shadow canvas, and straight to the display as 
+		// well where the window is not all on the shadow
+		Push_Any_Color_T<0>(block, n, first, flags);
+		if(frame_inside) {
+			return;
 		}
-		writeCmd8(CC);		
 	}
 
+	Begin_Pixels<PIXEL_BYTES>(first);
+
 	while (n-- > 0) {
 		if (isconst) {
 			h = pgm_read_byte(block++);
@@ -985,13 +1346,9 @@ void LCDWIKI_SPI::Push_Any_Color(uint8_t * block, int16_t n, bool first, uint8_t
 		}
 
 		color = (isbigend) ? (h << 8 | l) :  (l << 8 | h);
-		if(MODEL == ILI9488_18) {
-			writeData18(color);
-		} else {
-			writeData16(color);
-		}
+		Stage_Color<PIXEL_BYTES>(color);
 	}
-	CS_IDLE;
+	End_Pixels<PIXEL_BYTES>();
 }
 
 /*!
@@ -1009,23 +1366,28 @@ void LCDWIKI_SPI::Push_Any_Color(uint8_t * block, int16_t n, bool first, uint8_t
  *   Set_Addr_Window()
  */
 void LCDWIKI_SPI::Push_Same_Color(uint16_t color, uint16_t n, bool first) {
-
-	CS_ACTIVE;
-	if (first) {  
-		if(lcd_driver == ID_932X) {
-			writeCmd8(ILI932X_START_OSC);
-		}
-		writeCmd8(CC);
+	if(MODEL == ILI9488_18) {
+		Push_Same_Color_T<3>(color, n, first);
+	} else {
+		Push_Same_Color_T<2>(color, n, first);
 	}
+}
 
-	while (n-- > 0) {
-		if(MODEL == ILI9488_18) {
-			writeData18(color);
-		} else {
-			writeData16(color);
+// Push_Same_Color() for one pixel format, PIXEL_BYTES is 2 for rgb565 or 3 for rgb666
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Push_Same_Color_T(uint16_t color, uint16_t n, bool first) {
+	if(PIXEL_BYTES && frame_shadow) {
+		// into the frame's shadow canvas, and straight to the display as 
+		// well where the window is not all on the shadow
+		Push_Same_Color_T<0>(color, n, first);
+		if(frame_inside) {
+			return;
 		}
 	}
-	CS_IDLE;
+
+	Begin_Pixels<PIXEL_BYTES>(first);
+	Push_Color_Repeat<PIXEL_BYTES>(color, n);
+	End_Pixels<PIXEL_BYTES>();
 }
 
 /*!
@@ -1080,52 +1442,81 @@ uint16_t LCDWIKI_SPI::Read_Reg(uint16_t reg, int8_t index) {
  * @return 0 Surprisingly always returns 0 :)
  */
 int16_t LCDWIKI_SPI::Read_GRAM(int16_t x, int16_t y, uint16_t *block, int16_t w, int16_t h) {
-	uint16_t ret, dummy;
-	int16_t n = w * h;
-	uint8_t r, g, b, tmp;
+	// a full screen is more pixels than an int16_t can count
+	uint32_t n;
+	uint8_t r, g;
+
+	if((w <= 0) || (h <= 0)) {
+		return 0;
+	}
+	n = (uint32_t)w * h;
 
+	// the read is always from the display, even inside Begin_Frame(), so the
+	// shadow canvas is put aside to keep the window off it (and frame_inside
+	// as it was)
+	LCDWIKI_Canvas *shadow = frame_shadow;
+	frame_shadow = NULL;
+
+	// always program the window, the read is no place to trust the cache
+	Invalidate_Addr_Window();
 	Set_Addr_Window(x, y, x + w - 1, y + h - 1);
 
-	while (n > 0) {
-		CS_ACTIVE;
-		writeCmd16(RC);
-		setReadDir();
-		if(lcd_driver == ID_932X) {
-			while(n) {
-				for(int i =0; i< 2; i++) {
-					read8(r);
-					read8(r);
-					read8(r);
-					read8(g);
-				}
-				*block++ = (r<<8 | g);
-				n--;
+	CS_ACTIVE;
+	writeCmd16(RC);
+	setReadDir();
+
+	if(lcd_driver == ID_932X) {
+		while(n) {
+			for(int i =0; i< 2; i++) {
+				read8(r);
+				read8(r);
+				read8(r);
+				read8(g);
 			}
+			*block++ = (r<<8 | g);
+			n--;
+		}
 
-			Set_Addr_Window(0, 0, width - 1, height - 1);
-		} else  {
-			read8(r);
-			while (n) {
-				if(R24BIT == 1) {
-					read8(r);
-					read8(g);
-					read8(b);
-					ret = Color_To_565(r, g, b);
-				} else if(R24BIT == 0) {
-					read16(ret);
-				}
+		Set_Addr_Window(0, 0, width - 1, height - 1);
+	} else if(R24BIT == 1) {
+		// a dummy byte, then rgb666 as 3 bytes a pixel (in the top 6 bits of 
+		// each byte), read a staging buffer's worth at a time
+		read8(r);
+		while (n) {
+			uint8_t pixels = SPI_BLOCK_SIZE / 3;
+			if(pixels > n) {
+				pixels = n;
+			}
 
-				*block++ = ret;
-				n--;
+			uint8_t *p = spi_block;
+
+			bus.Read_Block(spi_block, pixels * 3);
+			n -= pixels;
+			while(pixels--) {
+				*block++ = ((p[0] & 0xF8) << 8) | ((p[1] & 0xFC) << 3) | (p[2] >> 3);
+				p += 3;
 			}
 		}
-
-		// set it back to that we are writing to the display
-		writeCmd16(CC);
-		CS_IDLE;
-		setWriteDir();
+	} else {
+		// a dummy byte, then rgb565 high byte first, which is read straight 
+		// into the block in one burst and put into byte order afterwards
+		uint8_t *p = (uint8_t *)block;
+
+		read8(r);
+		bus.Read_Block(p, n * 2);
+		while(n--) {
+			uint8_t hi = *p++;
+			uint8_t lo = *p++;
+			*block++ = (hi << 8) | lo;
+		}
 	}
 
+	// set it back to that we are writing to the display
+	writeCmd16(CC);
+	CS_IDLE;
+	setWriteDir();
+	frame_shadow = shadow;
+
 	return 0;
 }
 
@@ -1171,7 +1562,21 @@ uint16_t LCDWIKI_SPI::Read_ID(void) {
  *   function is a much faster way of doing this
  */
 void LCDWIKI_SPI::Draw_Pixe(int16_t x, int16_t y, uint16_t color) {
-	if((x < 0) || (y < 0) || (x > Get_Width()) || (y > Get_Height())) {
+	if((x < 0) || (y < 0) || (x >= Get_Width()) || (y >= Get_Height())) {
+		return;
+	}
+
+	if(frame_shadow && Frame_Covers(x, y, x, y)) {
+		frame_shadow->Draw_Pixe(x - frame_x, y - frame_y, color);
+		return;
+	}
+
+	if(lcd_driver == ID_1106) {
+		// the SH1106 only draws to its RAM buffer, SH1106_Display() sends it
+		if(SH1106_buffer) {
+			LCDWIKI_Mono_Canvas::Rect_Op(SH1106_buffer, WIDTH, x, y, 1, 1, color ? MONO_SET : MONO_CLEAR, 
+					SH1106_dirty_first, SH1106_dirty_last);
+		}
 		return;
 	}
 
@@ -1181,42 +1586,1074 @@ void LCDWIKI_SPI::Draw_Pixe(int16_t x, int16_t y, uint16_t color) {
 
 	if(lcd_driver == ID_1283A) {
 		writeData16(color);
-	} else if(lcd_driver == ID_1106) {
-		if(color) {
-			SH1106_buffer[(y/8)*WIDTH+x]|= (1<<(y%8))&0xff;
-		} else {
-			SH1106_buffer[(y/8)*WIDTH+x]&= ~((1<<(y%8))&0xff);
-		}
 	} else {
 		if(MODEL == ILI9488_18) {
+			uint8_t pixel[3];
+
+			Encode_Color<3>(color, pixel);
 			writeCmd8(CC);
-			writeData18(color);
+			CD_DATA;
+			Spi_Write_Block(pixel, 3);
 		} else {
 			writeCmdData16(CC, color);
 		}
 	}
 
-	CS_IDLE;
+	CS_IDLE;
+}
+
+/*!
+ * @brief Fill a rectangle starting from x, y with width w and height h.  If 
+ *   the rectangle will write out of bounds of the display, then it will be 
+ *   cropped to the edge of the display.  
+ *   i.e. fill area from x to x+w, y to y+h
+ * 
+ * @param x The x co-ordinate of the display
+ * @param y The y co-ordinate of the display
+ * 
+ * @param w The width of the rectangle
+ * @param h The height of the rectangle
+ * 
+ * @param color The rgb565 colour to fill the rectangle with
+ */
+void LCDWIKI_SPI::Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+	if(MODEL == ILI9488_18) {
+		Fill_Rect_T<3>(x, y, w, h, color);
+	} else {
+		Fill_Rect_T<2>(x, y, w, h, color);
+	}
+}
+
+// Fill_Rect() for one pixel format, PIXEL_BYTES is 2 for rgb565 or 3 for rgb666
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Fill_Rect_T(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+	if(!Clip_Rect(x, y, w, h)) {
+		return;
+	}
+
+	if(frame_shadow) {
+		// into the frame's shadow canvas, and straight to the display as 
+		// well where it is not all on the shadow
+		frame_shadow->Fill_Rect(x - frame_x, y - frame_y, w, h, color);
+		if(Frame_Covers(x, y, x + w - 1, y + h - 1)) {
+			return;
+		}
+	}
+
+	if(lcd_driver == ID_1106) {
+		// the SH1106 only draws to its RAM buffer
+		if(SH1106_buffer) {
+			LCDWIKI_Mono_Canvas::Rect_Op(SH1106_buffer, WIDTH, x, y, w, h, color ? MONO_SET : MONO_CLEAR, 
+					SH1106_dirty_first, SH1106_dirty_last);
+		}
+		return;
+	}
+
+	Set_Addr_Window(x, y, x + w - 1, y + h - 1);
+
+	CS_ACTIVE;
+	if(lcd_driver == ID_932X) {
+		writeCmd8(ILI932X_START_OSC);
+	}
+
+	writeCmd8(CC);
+	CD_DATA;
+	Push_Color_Repeat<PIXEL_BYTES>(color, (uint32_t)w * h);
+
+	if(lcd_driver == ID_932X) {
+		Set_Addr_Window(0, 0, width - 1, height - 1);
+	} else if(lcd_driver == ID_7575) {
+		Set_LR();
+	}
+
+	CS_IDLE;
+}
+
+/*!
+ * @brief Draw a line in the draw colour.  The line is walked with 
+ *   Bresenham's algorithm a run at a time, the pixels that share a row (or
+ *   a column, for a steep line) go out as one window and burst rather than
+ *   a window for every pixel.  The runs are cropped to the display.  Each
+ *   run goes through the virtual Fill_Rect(), the same way that 
+ *   LCDWIKI_GUI's Draw_Fast_HLine() and Draw_Fast_VLine() do.
+ *
+ * @param x1 The x co-ordinate of one end
+ * @param y1 The y co-ordinate of one end
+ * @param x2 The x co-ordinate of the other end
+ * @param y2 The y co-ordinate of the other end
+ */
+void LCDWIKI_SPI::Draw_Line(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	int16_t t;
+
+	if(y1 == y2) {
+		Fill_Rect((x1 < x2) ? x1 : x2, y1, abs(x2 - x1) + 1, 1, draw_color);
+		return;
+	}
+	if(x1 == x2) {
+		Fill_Rect(x1, (y1 < y2) ? y1 : y2, 1, abs(y2 - y1) + 1, draw_color);
+		return;
+	}
+
+	// nothing to draw if it is all off one side of the display
+	if(((x1 < 0) && (x2 < 0)) || ((y1 < 0) && (y2 < 0)) || 
+			((x1 >= width) && (x2 >= width)) || ((y1 >= height) && (y2 >= height))) {
+		return;
+	}
+
+	// walk along the major axis, which is x unless the line is steep
+	boolean steep = abs(y2 - y1) > abs(x2 - x1);
+	if(steep) {
+		t = x1; x1 = y1; y1 = t;
+		t = x2; x2 = y2; y2 = t;
+	}
+	if(x1 > x2) {
+		t = x1; x1 = x2; x2 = t;
+		t = y1; y1 = y2; y2 = t;
+	}
+
+	int16_t dx = x2 - x1;
+	int16_t dy = abs(y2 - y1);
+	int16_t err = dx / 2;
+	int16_t ystep = (y1 < y2) ? 1 : -1;
+	int16_t start = x1;
+
+	Begin_Batch();
+	for(; x1 <= x2; x1++) {
+		err -= dy;
+		if((err < 0) || (x1 == x2)) {
+			// the end of the run on this row (or column)
+			if(steep) {
+				Fill_Rect(y1, start, 1, x1 - start + 1, draw_color);
+			} else {
+				Fill_Rect(start, y1, x1 - start + 1, 1, draw_color);
+			}
+			start = x1 + 1;
+		}
+		if(err < 0) {
+			y1 += ystep;
+			err += dx;
+		}
+	}
+	End_Batch();
+}
+
+/*!
+ * @brief Send a canvas to the display with its top left at x, y, through a 
+ *   single address window (the canvas is cropped to the display).  The rows
+ *   go out back to back in one batch, so the chip stays selected.
+ *
+ * @param x The x co-ordinate of the display for the left of the canvas
+ * @param y The y co-ordinate of the display for the top of the canvas
+ * @param canvas The canvas to send
+ */
+void LCDWIKI_SPI::Blit_Canvas(int16_t x, int16_t y, const LCDWIKI_Canvas &canvas) {
+	Blit_Canvas_Rect(x, y, canvas, 0, 0, canvas.Get_Buffer_Width(), canvas.Get_Buffer_Height());
+}
+
+/*!
+ * @brief Send part of a canvas to the display, in the same way as 
+ *   Blit_Canvas()
+ *
+ * @param x The x co-ordinate of the display for the left of the part
+ * @param y The y co-ordinate of the display for the top of the part
+ * @param canvas The canvas to send from
+ * @param sx The left of the part on the canvas
+ * @param sy The top of the part on the canvas
+ * @param w The width of the part
+ * @param h The height of the part
+ *
+ * @warning The part must be on the canvas
+ */
+void LCDWIKI_SPI::Blit_Canvas_Rect(int16_t x, int16_t y, const LCDWIKI_Canvas &canvas, int16_t sx, int16_t sy, int16_t w, int16_t h) {
+	int16_t cw = canvas.Get_Buffer_Width();
+	const uint16_t *row;
+
+	if(!Crop_Blit(x, y, sx, sy, w, h)) {
+		return;
+	}
+
+	row = canvas.Get_Buffer() + (int32_t)sy * cw + sx;
+
+	if(lcd_driver == ID_1106) {
+		// the SH1106 only draws to its RAM buffer
+		for(int16_t j = 0; j < h; j++, row += cw) {
+			for(int16_t i = 0; i < w; i++) {
+				Draw_Pixe(x + i, y + j, row[i]);
+			}
+		}
+		return;
+	}
+
+	Set_Addr_Window(x, y, x + w - 1, y + h - 1);
+
+	Begin_Batch();
+	for(int16_t j = 0; j < h; j++, row += cw) {
+		Push_Any_Color((uint16_t *)row, w, j == 0, 0);
+	}
+	End_Batch();
+}
+
+/*!
+ * @brief Send a 1 bit per pixel canvas to the display with its top left at 
+ *   x, y, in two colours, through a single address window (the canvas is 
+ *   cropped to the display)
+ *
+ * @param x The x co-ordinate of the display for the left of the canvas
+ * @param y The y co-ordinate of the display for the top of the canvas
+ * @param canvas The canvas to send
+ * @param fg The rgb565 colour for the pixels that are set
+ * @param bg The rgb565 colour for the pixels that are clear
+ */
+void LCDWIKI_SPI::Blit_Mono_Canvas(int16_t x, int16_t y, const LCDWIKI_Mono_Canvas &canvas, uint16_t fg, uint16_t bg) {
+	int16_t cw = canvas.Get_Width();
+	int16_t w = cw;
+	int16_t h = canvas.Get_Height();
+	int16_t sx = 0;
+	int16_t sy = 0;
+	uint16_t run[16];
+	bool first = true;
+
+	if(!Crop_Blit(x, y, sx, sy, w, h)) {
+		return;
+	}
+
+	if(lcd_driver == ID_1106) {
+		for(int16_t j = 0; j < h; j++) {
+			for(int16_t i = 0; i < w; i++) {
+				Draw_Pixe(x + i, y + j, canvas.Read_Pixel(sx + i, sy + j) ? fg : bg);
+			}
+		}
+		return;
+	}
+
+	Set_Addr_Window(x, y, x + w - 1, y + h - 1);
+
+	Begin_Batch();
+	for(int16_t j = 0; j < h; j++) {
+		const uint8_t *src = canvas.Get_Buffer() + ((sy + j) / 8) * cw + sx;
+		uint8_t bit = 1 << ((sy + j) % 8);
+
+		// a short run of colours at a time, so that it fits on the stack
+		for(int16_t i = 0; i < w; ) {
+			uint8_t n = 0;
+
+			while((n < 16) && (i < w)) {
+				run[n++] = (src[i++] & bit) ? fg : bg;
+			}
+			Push_Any_Color(run, n, first, 0);
+			first = false;
+		}
+	}
+	End_Batch();
+}
+
+/*!
+ * @brief Send an indexed canvas to the display with its top left at x, y, 
+ *   through a single address window (the canvas is cropped to the 
+ *   display).  Each row is looked up in the palette a pixel at a time, 
+ *   straight into the staging buffer.
+ *
+ * @param x The x co-ordinate of the display for the left of the canvas
+ * @param y The y co-ordinate of the display for the top of the canvas
+ * @param canvas The canvas to send
+ */
+void LCDWIKI_SPI::Blit_Indexed_Canvas(int16_t x, int16_t y, const LCDWIKI_Indexed_Canvas &canvas) {
+	Blit_Indexed_Canvas_Rect(x, y, canvas, 0, 0, canvas.Get_Width(), canvas.Get_Height());
+}
+
+/*!
+ * @brief Send part of an indexed canvas to the display, in the same way as
+ *   Blit_Indexed_Canvas()
+ *
+ * @param x The x co-ordinate of the display for the left of the part
+ * @param y The y co-ordinate of the display for the top of the part
+ * @param canvas The canvas to send from
+ * @param sx The left of the part on the canvas
+ * @param sy The top of the part on the canvas
+ * @param w The width of the part
+ * @param h The height of the part
+ *
+ * @warning The part must be on the canvas
+ */
+void LCDWIKI_SPI::Blit_Indexed_Canvas_Rect(int16_t x, int16_t y, const LCDWIKI_Indexed_Canvas &canvas, int16_t sx, int16_t sy, int16_t w, int16_t h) {
+	if(MODEL == ILI9488_18) {
+		Blit_Indexed_Canvas_T<3>(x, y, canvas, sx, sy, w, h);
+	} else {
+		Blit_Indexed_Canvas_T<2>(x, y, canvas, sx, sy, w, h);
+	}
+}
+
+// Blit_Indexed_Canvas_Rect() for one pixel format, PIXEL_BYTES is 2 for rgb565 or 3 for rgb666
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Blit_Indexed_Canvas_T(int16_t x, int16_t y, const LCDWIKI_Indexed_Canvas &canvas, int16_t sx, int16_t sy, int16_t w, int16_t h) {
+	if(PIXEL_BYTES && frame_shadow && (lcd_driver != ID_1106)) {
+		// into the frame's shadow canvas, and straight to the display as 
+		// well where it is not all on the shadow
+		Blit_Indexed_Canvas_T<0>(x, y, canvas, sx, sy, w, h);
+		if(frame_inside) {
+			return;
+		}
+	}
+
+	if(!Crop_Blit(x, y, sx, sy, w, h)) {
+		return;
+	}
+
+	if(lcd_driver == ID_1106) {
+		for(int16_t j = 0; j < h; j++) {
+			for(int16_t i = 0; i < w; i++) {
+				Draw_Pixe(x + i, y + j, canvas.Get_Color(canvas.Get_Index(sx + i, sy + j)));
+			}
+		}
+		return;
+	}
+
+	Set_Addr_Window(x, y, x + w - 1, y + h - 1);
+
+	Begin_Pixels<PIXEL_BYTES>(true);
+	for(int16_t j = 0; j < h; j++) {
+		for(int16_t i = 0; i < w; i++) {
+			Stage_Color<PIXEL_BYTES>(canvas.Get_Color(canvas.Get_Index(sx + i, sy + j)));
+		}
+	}
+	End_Pixels<PIXEL_BYTES>();
+}
+
+/*!
+ * @brief Change one colour of the palette of an indexed canvas that is on 
+ *   the display with its top left at x, y, and recolour it on the display.
+ *   Only the row spans that use the index are sent (with gaps of up to 
+ *   PALETTE_SPAN_GAP other pixels sent along with them), so blinking or 
+ *   pulsing a small indicator costs about as much as drawing it.  The spans
+ *   are found from the canvas index map (LCDWIKI_Indexed_Canvas::Set_Index_Map()),
+ *   or from the whole canvas without one.
+ *
+ * @param x The x co-ordinate of the display for the left of the canvas
+ * @param y The y co-ordinate of the display for the top of the canvas
+ * @param canvas The canvas, its palette must be in RAM
+ * @param index The palette index to change
+ * @param color The new rgb565 colour
+ */
+void LCDWIKI_SPI::Set_Palette_Entry(int16_t x, int16_t y, LCDWIKI_Indexed_Canvas &canvas, uint8_t index, uint16_t color) {
+	if(!canvas.Set_Palette_Entry(index, color)) {
+		return;
+	}
+
+	lcd_rect r = canvas.Get_Index_Bounds(index);
+	if(r.x1 > r.x2) {
+		return;
+	}
+
+	Begin_Batch();
+	for(int16_t j = r.y1; j <= r.y2; j++) {
+		if(!canvas.Index_In_Row(index, j)) {
+			continue;
+		}
+
+		int16_t i = r.x1;
+		for(;;) {
+			while((i <= r.x2) && (canvas.Get_Index(i, j) != index)) {
+				i++;
+			}
+			if(i > r.x2) {
+				break;
+			}
+
+			// the span runs on over short gaps to the last pixel of the index
+			int16_t first = i;
+			int16_t last = i;
+			for(i++; (i <= r.x2) && (i - last <= PALETTE_SPAN_GAP + 1); i++) {
+				if(canvas.Get_Index(i, j) == index) {
+					last = i;
+				}
+			}
+
+			Blit_Indexed_Canvas_Rect(x + first, y + j, canvas, first, j, last - first + 1, 1);
+			i = last + 1;
+		}
+	}
+	End_Batch();
+}
+
+/*!
+ * @brief Recolour one index of an image in the Push_Indexed_Image() format
+ *   that is on the display with its top left at x, y.  The image data is 
+ *   decoded again to find the row spans that use the index, and only those
+ *   are sent, with gaps of up to PALETTE_SPAN_GAP other pixels sent along
+ *   with them in their own colours.  With the index map that 
+ *   Push_Indexed_Image() built, the rows without the index are passed over
+ *   a run at a time and decoding stops after the last row that has it.
+ *
+ *   The colour map of an image in RAM (block is not const) is changed as 
+ *   well, so that it is drawn in the new colour from then on.
+ *
+ * @param x The x co-ordinate of the display for the left of the image
+ * @param y The y co-ordinate of the display for the top of the image
+ * @param block The image
+ * @param flags 00000001 - the image is in PROGMEM, else RAM
+ * @param index The colour map index to change
+ * @param color The new rgb565 colour
+ * @param bounds The bounds of each index from Push_Indexed_Image(), or NULL
+ *   to look through the whole image
+ * @param rows The rows of each index from Push_Indexed_Image(), or NULL
+ */
+void LCDWIKI_SPI::Set_Palette_Entry(int16_t x, int16_t y, uint8_t *block, uint8_t flags, uint8_t index, uint16_t color, 
+		const lcd_rect *bounds, const uint8_t *rows) {
+	bool isconst = flags & 1;
+	uint16_t w;
+	uint16_t h;
+	uint8_t numEntries;
+	uint8_t numberToDraw;
+	uint8_t colorIndex = 0;
+	const uint8_t *data = block;
+	const uint8_t *map = lcd_read_indexed_header(data, flags, w, h, numEntries);
+
+	if((index >= numEntries) || (w == 0) || (h == 0)) {
+		return;
+	}
+	if(!isconst) {
+		// the colour map is in the caller's RAM image, at the same offset
+		uint8_t *entry = block + (map - block) + index * 2;
+		entry[0] = color >> 8;
+		entry[1] = color;
+	}
+
+	// the rows that can have the index
+	int16_t firstRow = 0;
+	int16_t lastRow = h - 1;
+	if(bounds) {
+		if(bounds[index].x1 > bounds[index].x2) {
+			return;
+		}
+		firstRow = bounds[index].y1;
+		lastRow = bounds[index].y2;
+	}
+	rows = (bounds && rows) ? rows + index * ((h + 7) / 8) : NULL;
+
+	int16_t right = x + w - 1;
+	if(right >= Get_Width()) {
+		right = Get_Width() - 1;
+	}
+
+	#define NEXT_BYTE() (isconst ? pgm_read_byte(data++) : *data++)
+	#define MAP_COLOR(i) ((i) == index ? color : isconst ? \
+			(uint16_t)((pgm_read_byte(map + (i) * 2) << 8) | pgm_read_byte(map + (i) * 2 + 1)) : \
+			(uint16_t)((map[(i) * 2] << 8) | map[(i) * 2 + 1]))
+
+	// the span that is open on this row: its first column (-1 for none), the
+	// column of the next pixel to send, its pixels that are waiting to be 
+	// sent and the other pixels since the last one of the index
+	int16_t spanCol = -1;
+	int16_t spanNext = 0;
+	bool spanFirst = false;
+	uint16_t span[16];
+	uint8_t spanLen = 0;
+	uint16_t gap[PALETTE_SPAN_GAP + 1];
+	uint8_t gapLen = 0;
+
+	#define SPAN_FLUSH() do { \
+		if(lcd_driver == ID_1106) { \
+			for(uint8_t k = 0; k < spanLen; k++) { \
+				Draw_Pixe(x + spanNext + k, y + row, span[k]); \
+			} \
+		} else if(spanLen) { \
+			if(spanFirst) { \
+				Set_Addr_Window(x + spanNext, y + row, right, y + row); \
+			} \
+			Push_Any_Color(span, spanLen, spanFirst, 0); \
+			spanFirst = false; \
+		} \
+		spanNext += spanLen; \
+		spanLen = 0; \
+	} while(0)
+	#define SPAN_PUT(c) do { \
+		span[spanLen++] = (c); \
+		if(spanLen == sizeof(span) / sizeof(span[0])) { \
+			SPAN_FLUSH(); \
+		} \
+	} while(0)
+
+	// the pixel that the next one decoded goes to, and whether its row is 
+	// on the display and can have the index
+	uint16_t col = 0;
+	int16_t row = 0;
+	bool want = (firstRow <= 0) && (!rows || (rows[0] & 1)) && (y >= 0) && (y < Get_Height());
+
+	Begin_Batch();
+	while(row <= lastRow) {
+		numberToDraw = NEXT_BYTE();
+
+		bool repeat = numberToDraw & 0x80;
+		numberToDraw &= 0x7F;
+		if(repeat) {
+			colorIndex = NEXT_BYTE();
+		}
+
+		while(numberToDraw > 0) {
+			uint8_t n = 1;
+
+			if(!repeat) {
+				colorIndex = NEXT_BYTE();
+			}
+
+			if((spanCol < 0) && repeat && (!want || (colorIndex != index))) {
+				// nothing to send, on to the end of the run or the row
+				n = (numberToDraw < w - col) ? numberToDraw : w - col;
+			} else if(want && (colorIndex == index) && (x + (int16_t)col >= 0) && (x + (int16_t)col <= right)) {
+				if(spanCol < 0) {
+					spanCol = col;
+					spanNext = col;
+					spanFirst = true;
+				}
+				for(uint8_t k = 0; k < gapLen; k++) {
+					SPAN_PUT(gap[k]);
+				}
+				gapLen = 0;
+				SPAN_PUT(color);
+			} else if(spanCol >= 0) {
+				if(gapLen < PALETTE_SPAN_GAP) {
+					gap[gapLen++] = MAP_COLOR(colorIndex);
+				} else {
+					SPAN_FLUSH();
+					spanCol = -1;
+					gapLen = 0;
+				}
+			}
+
+			numberToDraw -= n;
+			col += n;
+			if(col == w) {
+				if(spanCol >= 0) {
+					SPAN_FLUSH();
+					spanCol = -1;
+					gapLen = 0;
+				}
+				col = 0;
+				if(++row > lastRow) {
+					break;
+				}
+				want = (row >= firstRow) && (!rows || ((rows[row / 8] >> (row & 7)) & 1)) && 
+						(y + row >= 0) && (y + row < Get_Height());
+			}
+		}
+	}
+	End_Batch();
+
+	#undef SPAN_PUT
+	#undef SPAN_FLUSH
+	#undef MAP_COLOR
+	#undef NEXT_BYTE
+}
+
+/*!
+ * @brief Draw a 1 bit per pixel glyph, such as a character of a font.  Each
+ *   row of the bitmap is (w + 7) / 8 bytes, with the leftmost pixel in the 
+ *   top bit of the first byte.  An opaque glyph goes out through a single 
+ *   address window, its bits expanded straight into the staging buffer two
+ *   pixels at a time from a table of the four fg/bg pixel pairs.  A 
+ *   transparent glyph is drawn a run of set pixels at a time.  The glyph is
+ *   cropped to the display.
+ *
+ * @param x The left of the glyph
+ * @param y The top of the glyph
+ * @param bitmap The rows of the glyph
+ * @param w The width of the glyph
+ * @param h The height of the glyph
+ * @param fg The rgb565 colour of the set pixels
+ * @param bg The rgb565 colour of the clear pixels
+ * @param flags 00000001 - the bitmap is in PROGMEM, else RAM
+ *   00000010 - transparent, only the set pixels are drawn
+ */
+void LCDWIKI_SPI::Draw_Glyph(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg, uint8_t flags) {
+	bool isconst = flags & 1;
+	int16_t stride = (w + 7) / 8;
+
+	if(flags & 2) {
+		Begin_Batch();
+		for(int16_t j = 0; j < h; j++) {
+			const uint8_t *row = bitmap + j * stride;
+			int16_t start = -1;
+
+			for(int16_t i = 0; i <= w; i++) {
+				bool set = false;
+				if(i < w) {
+					uint8_t b = isconst ? pgm_read_byte(row + i / 8) : row[i / 8];
+					set = (b << (i & 7)) & 0x80;
+				}
+
+				if(set && (start < 0)) {
+					start = i;
+				} else if(!set && (start >= 0)) {
+					Fill_Rect(x + start, y + j, i - start, 1, fg);
+					start = -1;
+				}
+			}
+		}
+		End_Batch();
+		return;
+	}
+
+	if(MODEL == ILI9488_18) {
+		Draw_Glyph_T<3>(x, y, bitmap, w, h, fg, bg, flags);
+	} else {
+		Draw_Glyph_T<2>(x, y, bitmap, w, h, fg, bg, flags);
+	}
+}
+
+/*!
+ * @brief Draw a 2 or 4 bit per pixel anti-aliased glyph on a known solid 
+ *   background, without reading the display back.  Each pixel is the 
+ *   coverage of the glyph from 0 (all bg) to 3 or 15 (all fg), and each row
+ *   of the bitmap is (w * bits + 7) / 8 bytes, with the leftmost pixel in 
+ *   the top bits of the first byte.  The 4 or 16 blended colours are worked
+ *   out once for each fg and bg (see Set_Alpha_Colors()), so a glyph goes
+ *   out through a single address window for about the same cost per pixel
+ *   as Draw_Glyph(), each pixel copied ready encoded from the table.  The 
+ *   glyph is cropped to the display.
+ *
+ * @param x The left of the glyph
+ * @param y The top of the glyph
+ * @param bitmap The rows of the glyph
+ * @param w The width of the glyph
+ * @param h The height of the glyph
+ * @param bits The bits per pixel, 2 or 4
+ * @param fg The rgb565 colour of the glyph
+ * @param bg The rgb565 colour of the background
+ * @param flags 00000001 - the bitmap is in PROGMEM, else RAM
+ *
+ * @warning The whole cell is drawn, there is no transparent mode since a 
+ *   blended pixel needs the colour that is under it
+ */
+void LCDWIKI_SPI::Draw_Alpha_Glyph(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint8_t bits, uint16_t fg, uint16_t bg, uint8_t flags) {
+	if((bits != 2) && (bits != 4)) {
+		Draw_Glyph(x, y, bitmap, w, h, fg, bg, flags & 1);
+		return;
+	}
+
+	Set_Alpha_Colors(bits, fg, bg);
+	if(MODEL == ILI9488_18) {
+		Draw_Alpha_Glyph_T<3>(x, y, bitmap, w, h, bits, flags);
+	} else {
+		Draw_Alpha_Glyph_T<2>(x, y, bitmap, w, h, bits, flags);
+	}
+}
+
+/*!
+ * @brief Work out the colours for each level of alpha, blending each of the
+ *   red, green and blue fields from bg at 0 to fg at the last level, unless
+ *   they are already there from the last glyph
+ *
+ * @param bits The bits per pixel, 2 or 4
+ * @param fg The rgb565 colour of the glyph
+ * @param bg The rgb565 colour of the background
+ */
+void LCDWIKI_SPI::Set_Alpha_Colors(uint8_t bits, uint16_t fg, uint16_t bg) {
+	if((bits == alpha_bits) && (fg == alpha_fg) && (bg == alpha_bg)) {
+		return;
+	}
+
+	uint8_t top = (1 << bits) - 1;
+	for(uint8_t a = 0; a <= top; a++) {
+		uint8_t r = ((bg >> 11) * (top - a) + (fg >> 11) * a + top / 2) / top;
+		uint8_t g = (((bg >> 5) & 0x3F) * (top - a) + ((fg >> 5) & 0x3F) * a + top / 2) / top;
+		uint8_t b = ((bg & 0x1F) * (top - a) + (fg & 0x1F) * a + top / 2) / top;
+		alpha_lut[a] = (r << 11) | (g << 5) | b;
+	}
+
+	alpha_bits = bits;
+	alpha_fg = fg;
+	alpha_bg = bg;
+}
+
+/*!
+ * @brief Draw a UTF-8 string in an indexed font (see LCDWIKI_Font), a glyph
+ *   at a time with Draw_Glyph(), or Draw_Alpha_Glyph() for an anti-aliased
+ *   font.  Each glyph is found with a binary search of the font's index, so
+ *   the time to draw a character does not grow with the number of 
+ *   characters in the font.  A character that the font does not have is 
+ *   left as a gap (of the background colour when opaque).
+ *
+ * @param x The left of the first character
+ * @param y The top of the string
+ * @param font The font
+ * @param str The string
+ * @param fg The rgb565 colour of the text
+ * @param bg The rgb565 colour of the background
+ * @param flags 00000010 - transparent, only the text is drawn (not for an
+ *   anti-aliased font, which is always drawn on bg)
+ *
+ * @return The x co-ordinate after the last character
+ */
+int16_t LCDWIKI_SPI::Draw_Font_String(int16_t x, int16_t y, const LCDWIKI_Font &font, const char *str, uint16_t fg, uint16_t bg, uint8_t flags) {
+	int16_t w = font.Get_Width();
+	int16_t h = font.Get_Height();
+	uint8_t bits = font.Get_Bits();
+	uint16_t code;
+
+	if(bits > 1) {
+		flags &= ~2;
+	}
+
+	Begin_Batch();
+	while((code = LCDWIKI_Font::Next_Char(str)) != 0) {
+		const uint8_t *glyph = font.Find(code);
+
+		if(glyph && (bits > 1)) {
+			Draw_Alpha_Glyph(x, y, glyph, w, h, bits, fg, bg, 1);
+		} else if(glyph) {
+			Draw_Glyph(x, y, glyph, w, h, fg, bg, flags | 1);
+		} else if(!(flags & 2)) {
+			Fill_Rect(x, y, w, h, bg);
+		}
+		x += w;
+	}
+	End_Batch();
+
+	return x;
+}
+
+// Draw_Glyph() of an opaque glyph for one pixel format, PIXEL_BYTES is 2 for rgb565 or 3 for rgb666
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Draw_Glyph_T(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg, uint8_t flags) {
+	bool isconst = flags & 1;
+	int16_t stride = (w + 7) / 8;
+	int16_t sx = 0;
+	int16_t sy = 0;
+
+	if(PIXEL_BYTES && frame_shadow && (lcd_driver != ID_1106)) {
+		// into the frame's shadow canvas, and straight to the display as 
+		// well where it is not all on the shadow
+		Draw_Glyph_T<0>(x, y, bitmap, w, h, fg, bg, flags);
+		if(frame_inside) {
+			return;
+		}
+	}
+
+	int16_t gw = w;
+	if(!Crop_Blit(x, y, sx, sy, w, h)) {
+		return;
+	}
+
+	#define GLYPH_BIT(i, j) (((isconst ? pgm_read_byte(bitmap + (j) * stride + (i) / 8) : bitmap[(j) * stride + (i) / 8]) << ((i) & 7)) & 0x80)
+
+	if(lcd_driver == ID_1106) {
+		for(int16_t j = 0; j < h; j++) {
+			for(int16_t i = 0; i < w; i++) {
+				Draw_Pixe(x + i, y + j, GLYPH_BIT(sx + i, sy + j) ? fg : bg);
+			}
+		}
+		return;
+	}
+
+	Set_Addr_Window(x, y, x + w - 1, y + h - 1);
+	Begin_Pixels<PIXEL_BYTES>(true);
+
+	if(!PIXEL_BYTES || (sx != 0) || (w != gw)) {
+		// cropped at the side (or into the shadow canvas), a pixel at a time
+		for(int16_t j = 0; j < h; j++) {
+			for(int16_t i = 0; i < w; i++) {
+				Stage_Color<PIXEL_BYTES>(GLYPH_BIT(sx + i, sy + j) ? fg : bg);
+			}
+		}
+	} else {
+		// the four pairs of pixels that two bits can be, encoded once
+		uint8_t pairs[4][6];
+		for(uint8_t k = 0; k < 4; k++) {
+			Encode_Color<PIXEL_BYTES>((k & 2) ? fg : bg, pairs[k]);
+			Encode_Color<PIXEL_BYTES>((k & 1) ? fg : bg, pairs[k] + PIXEL_BYTES);
+		}
+
+		for(int16_t j = 0; j < h; j++) {
+			const uint8_t *row = bitmap + (sy + j) * stride;
+
+			for(int16_t i = 0; i < w; i += 8) {
+				uint8_t b = isconst ? pgm_read_byte(row++) : *row++;
+				int16_t n = (w - i < 8) ? w - i : 8;
+
+				// whole pairs from the table, then an odd last pixel
+				for(; n >= 2; n -= 2, b <<= 2) {
+					if(spi_block_len > SPI_BLOCK_SIZE - 2 * PIXEL_BYTES) {
+						Flush_Block();
+					}
+					memcpy(spi_block + spi_block_len, pairs[b >> 6], 2 * PIXEL_BYTES);
+					spi_block_len += 2 * PIXEL_BYTES;
+					if(spi_block_len > SPI_BLOCK_SIZE - PIXEL_BYTES) {
+						Flush_Block();
+					}
+				}
+				if(n) {
+					Stage_Color<PIXEL_BYTES>((b & 0x80) ? fg : bg);
+				}
+			}
+		}
+	}
+
+	#undef GLYPH_BIT
+
+	End_Pixels<PIXEL_BYTES>();
+}
+
+// Draw_Alpha_Glyph() for one pixel format, PIXEL_BYTES is 2 for rgb565 or 3 for rgb666
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Draw_Alpha_Glyph_T(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint8_t bits, uint8_t flags) {
+	bool isconst = flags & 1;
+	int16_t stride = (w * bits + 7) / 8;
+	uint8_t mask = (1 << bits) - 1;
+	int16_t sx = 0;
+	int16_t sy = 0;
+
+	if(PIXEL_BYTES && frame_shadow && (lcd_driver != ID_1106)) {
+		// into the frame's shadow canvas, and straight to the display as 
+		// well where it is not all on the shadow
+		Draw_Alpha_Glyph_T<0>(x, y, bitmap, w, h, bits, flags);
+		if(frame_inside) {
+			return;
+		}
+	}
+
+	int16_t gw = w;
+	if(!Crop_Blit(x, y, sx, sy, w, h)) {
+		return;
+	}
+
+	#define GLYPH_ALPHA(i, j) (((isconst ? pgm_read_byte(bitmap + (j) * stride + (i) * bits / 8) : bitmap[(j) * stride + (i) * bits / 8]) >> (8 - bits - (i) * bits % 8)) & mask)
+
+	if(lcd_driver == ID_1106) {
+		// one bit panel, the pixels that are at least half covered
+		for(int16_t j = 0; j < h; j++) {
+			for(int16_t i = 0; i < w; i++) {
+				Draw_Pixe(x + i, y + j, (GLYPH_ALPHA(sx + i, sy + j) > mask / 2) ? alpha_fg : alpha_bg);
+			}
+		}
+		return;
+	}
+
+	Set_Addr_Window(x, y, x + w - 1, y + h - 1);
+	Begin_Pixels<PIXEL_BYTES>(true);
+
+	if(!PIXEL_BYTES || (sx != 0) || (w != gw)) {
+		// cropped at the side (or into the shadow canvas), a pixel at a time
+		for(int16_t j = 0; j < h; j++) {
+			for(int16_t i = 0; i < w; i++) {
+				Stage_Color<PIXEL_BYTES>(alpha_lut[GLYPH_ALPHA(sx + i, sy + j)]);
+			}
+		}
+	} else {
+		// each level encoded once, then copied straight into the staging buffer
+		uint8_t levels[16][3];
+		for(uint8_t k = 0; k <= mask; k++) {
+			Encode_Color<PIXEL_BYTES>(alpha_lut[k], levels[k]);
+		}
+
+		uint8_t per_byte = 8 / bits;
+		for(int16_t j = 0; j < h; j++) {
+			const uint8_t *row = bitmap + (sy + j) * stride;
+
+			for(int16_t i = 0; i < w; i += per_byte) {
+				uint8_t b = isconst ? pgm_read_byte(row++) : *row++;
+				int16_t n = (w - i < per_byte) ? w - i : per_byte;
+
+				for(; n > 0; n--, b <<= bits) {
+					const uint8_t *level = levels[b >> (8 - bits)];
+					spi_block[spi_block_len++] = level[0];
+					spi_block[spi_block_len++] = level[1];
+					if(PIXEL_BYTES == 3) {
+						spi_block[spi_block_len++] = level[2];
+					}
+					if(spi_block_len > SPI_BLOCK_SIZE - PIXEL_BYTES) {
+						Flush_Block();
+					}
+				}
+			}
+		}
+	}
+
+	#undef GLYPH_ALPHA
+
+	End_Pixels<PIXEL_BYTES>();
+}
+
+/*!
+ * @brief Crop a part of a canvas that is to be sent to the display with its
+ *   top left at x, y, to the display
+ *
+ * @param x The x co-ordinate of the display, updated to the cropped part
+ * @param y The y co-ordinate of the display, updated to the cropped part
+ * @param sx The left of the part on the canvas, updated to the cropped part
+ * @param sy The top of the part on the canvas, updated to the cropped part
+ * @param w The width, updated to the cropped part
+ * @param h The height, updated to the cropped part
+ *
+ * @return whether there is anything left to send
+ */
+boolean LCDWIKI_SPI::Crop_Blit(int16_t &x, int16_t &y, int16_t &sx, int16_t &sy, int16_t &w, int16_t &h) {
+	if(x < 0) {
+		sx -= x;
+		w += x;
+		x = 0;
+	}
+	if(y < 0) {
+		sy -= y;
+		h += y;
+		y = 0;
+	}
+	if(x + w > Get_Width()) {
+		w = Get_Width() - x;
+	}
+	if(y + h > Get_Height()) {
+		h = Get_Height() - y;
+	}
+
+	return((w > 0) && (h > 0));
+}
+
+/*!
+ * @brief Compose the whole display in a canvas that is much smaller than it,
+ *   one band at a time.  The canvas is moved over the display from the top
+ *   left, a canvas-sized band at a time (so a canvas as wide as the display
+ *   makes horizontal bands).  For each band, draw is called to draw the 
+ *   whole display onto the canvas, which keeps only the part in the band, 
+ *   and the band is then sent with one address window.  Nothing half drawn
+ *   is ever seen, for the RAM of just the canvas:
+ *
+ *     void draw_screen(LCDWIKI_GUI &gui, void *arg) {
+ *       gui.Fill_Screen(BLACK);
+ *       gui.Set_Draw_color(RED);
+ *       gui.Fill_Circle(160, 240, 100);
+ *     }
+ *
+ *     uint16_t band_buffer[320 * 2];
+ *     LCDWIKI_Canvas band(320, 2, band_buffer);
+ *     mylcd.Render_Bands(band, draw_screen, NULL);
+ *
+ * @param band The canvas to draw each band in
+ * @param draw Draws the whole display, in display co-ordinates.  The band
+ *   is not cleared in between, so it should start with the background.
+ * @param arg The argument to pass to draw
+ */
+void LCDWIKI_SPI::Render_Bands(LCDWIKI_Canvas &band, lcd_draw_callback draw, void *arg) {
+	int16_t bw = band.Get_Buffer_Width();
+	int16_t bh = band.Get_Buffer_Height();
+
+	for(int16_t y = 0; y < Get_Height(); y += bh) {
+		for(int16_t x = 0; x < Get_Width(); x += bw) {
+			band.Set_View(x, y, Get_Width(), Get_Height());
+			draw(band, arg);
+			Blit_Canvas(x, y, band);
+		}
+	}
+
+	band.Set_View(0, 0, bw, bh);
+}
+
+/*!
+ * @brief Start drawing a frame.  Until End_Frame(), everything that is drawn
+ *   on the part of the display under the shadow canvas goes to the shadow 
+ *   instead, and the pixels that it changes are added to the damage list.
+ *   End_Frame() then sends only those, merged into a few rectangles.  This
+ *   suits a screen where a few small fields change each frame: redrawing a
+ *   field with the same value sends nothing at all.
+ *
+ *   The shadow must hold what is on the display under it, for example 
+ *   fill both the same colour before the first frame, or Blit_Canvas() it. 
+ *   It can cover the whole display or (where there is not the RAM for that)
+ *   just the part that is redrawn each frame.  Drawing that is not all on 
+ *   the shadow goes straight to the display, and to the shadow as well, so 
+ *   that it stays in step.
+ *
+ *     uint16_t shadow_buffer[120 * 40];
+ *     LCDWIKI_Canvas shadow(120, 40, shadow_buffer);
+ *     LCDWIKI_Damage damage;
+ *
+ *     mylcd.Begin_Frame(shadow, damage, 200, 10);
+ *     mylcd.Print_Number_Int(speed, 200, 10, 5, ' ', 10);
+ *     mylcd.End_Frame();
+ *
+ * @param shadow The canvas that stands in for the display
+ * @param damage Where the changed rectangles are kept until End_Frame()
+ * @param x The x co-ordinate of the display for the left of the shadow
+ * @param y The y co-ordinate of the display for the top of the shadow
+ *
+ * @note Read_GRAM() and Vert_Scroll() still go to the display itself
+ */
+void LCDWIKI_SPI::Begin_Frame(LCDWIKI_Canvas &shadow, LCDWIKI_Damage &damage, int16_t x, int16_t y) {
+	Wait_Async();
+
+	frame_shadow = &shadow;
+	frame_damage = &damage;
+	frame_x = x;
+	frame_y = y;
+	frame_inside = false;
+	shadow.Set_Damage(&damage);
+}
+
+/*!
+ * @brief Finish the frame started by Begin_Frame(), and send the damaged 
+ *   parts of the shadow to the display, in the order that needs the fewest
+ *   address window changes (see LCDWIKI_Damage::Sort()).  The damage list
+ *   is cleared.
+ */
+void LCDWIKI_SPI::End_Frame(void) {
+	LCDWIKI_Canvas *shadow = frame_shadow;
+
+	if(!shadow) {
+		return;
+	}
+
+	frame_shadow = NULL;
+	shadow->Set_Damage(NULL);
+	frame_damage->Sort();
+
+	Begin_Batch();
+	for(uint8_t i = 0; i < frame_damage->Get_Count(); i++) {
+		const lcd_rect &r = frame_damage->Get_Rect(i);
+
+		Blit_Canvas_Rect(frame_x + r.x1, frame_y + r.y1, *shadow, r.x1, r.y1, r.x2 - r.x1 + 1, r.y2 - r.y1 + 1);
+	}
+	End_Batch();
+
+	frame_damage->Clear();
+}
+
+/*!
+ * @brief Set the frame's shadow canvas to the same address window, see 
+ *   Begin_Frame()
+ *
+ * @return whether the window is all on the shadow, in which case nothing 
+ *   needs to go to the display
+ */
+boolean LCDWIKI_SPI::Frame_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	frame_shadow->Set_Addr_Window(x1 - frame_x, y1 - frame_y, x2 - frame_x, y2 - frame_y);
+	frame_inside = Frame_Covers(x1, y1, x2, y2);
+
+	return frame_inside;
+}
+
+/*!
+ * @brief Whether a rectangle of the display is all on the frame's shadow 
+ *   canvas
+ */
+boolean LCDWIKI_SPI::Frame_Covers(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+	return((x1 >= frame_x) && (y1 >= frame_y) && 
+			(x2 < frame_x + frame_shadow->Get_Buffer_Width()) && (y2 < frame_y + frame_shadow->Get_Buffer_Height()));
 }
 
 /*!
- * @brief Fill a rectangle starting from x, y with width w and height h.  If 
- *   the rectangle will write out of bounds of the display, then it will be 
- *   cropped to the edge of the display.  
- *   i.e. fill area from x to x+w, y to y+h
- * 
- * @param x The x co-ordinate of the display
- * @param y The y co-ordinate of the display
- * 
- * @param w The width of the rectangle
- * @param h The height of the rectangle
- * 
- * @param color The rgb565 colour to fill the rectangle with
+ * @brief Crop a rectangle to the display, a negative width or height is 
+ *   taken to run left or up from x, y.
+ *
+ * @param x The x co-ordinate, updated to the cropped rectangle
+ * @param y The y co-ordinate, updated to the cropped rectangle
+ * @param w The width, updated to the cropped rectangle
+ * @param h The height, updated to the cropped rectangle
+ *
+ * @return whether there is anything left of the rectangle to draw
  */
-void LCDWIKI_SPI::Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+boolean LCDWIKI_SPI::Clip_Rect(int16_t &x, int16_t &y, int16_t &w, int16_t &h) {
 	int16_t end;
 
 	if (w < 0) {
+
 		w = -w;
 		x -= w;
 	}                           //+ve w
@@ -1246,50 +2683,232 @@ void LCDWIKI_SPI::Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t
 	}
 	h = end - y;
 
-	Set_Addr_Window(x, y, x + w - 1, y + h - 1);
+	return((w > 0) && (h > 0));
+}
+
+/*!
+ * @brief Start pushing n colours to the display memory at the address window
+ *   that is already set, and return as soon as the first chunk is on the 
+ *   wire.  Where the transport has DMA (see LCDWIKI_TRANSPORT_ASYNC), the 
+ *   colours are encoded a chunk at a time into one buffer while the other 
+ *   one is being sent.  The rest of the push is moved along by Is_Busy(), 
+ *   and once the last chunk is off the wire the callback set with 
+ *   Set_Async_Callback() is called.
+ *
+ * @param block The colours in rgb565 format, this must not change until the 
+ *   push has finished
+ * @param n The number of colours in the block
+ * @param first Whether this is the first write to the display - set this to 
+ *   true to send the command that starts the memory write
+ * @param flags 00000001 - the block is in PROGMEM, else RAM
+ *
+ * @warning Anything else that is drawn waits for the push to finish first, 
+ *   so there is no point calling the other drawing functions while 
+ *   Is_Busy() returns true.  Where there is no DMA the whole push is sent 
+ *   before this returns.  Nothing is sent to the SH1106, only the callback 
+ *   is called.
+ */
+void LCDWIKI_SPI::Push_Any_Color_Async(const uint16_t *block, uint32_t n, bool first, uint8_t flags) {
+	if(frame_shadow || (lcd_driver == ID_1106)) {
+		// a frame is drawn to its shadow canvas, so there is nothing to wait 
+		// for, and the SH1106 only draws to its RAM buffer, which has no 
+		// address window for a stream of colours to go into
+		while(frame_shadow && (n > 0)) {
+			int16_t pixels = (n > 0x4000) ? 0x4000 : n;
+
+			Push_Any_Color((uint16_t *)block, pixels, first, flags);
+			block += pixels;
+			n -= pixels;
+			first = false;
+		}
+
+		if(async_callback) {
+			async_callback(async_arg);
+		}
+		return;
+	}
 
 	CS_ACTIVE;
-	if(lcd_driver == ID_1106) {
-		int16_t i;
-		int16_t j;
+	if (first) {
+		if(lcd_driver == ID_932X) {
+			writeCmd8(ILI932X_START_OSC);
+		}
+		writeCmd8(CC);
+	}
+	CD_DATA;
+
+	async_fill = false;
+	async_src = block;
+	async_flags = flags;
+	async_left = n;
+	async_len = 0;
+	async_which = 0;
+	async_active = true;
+	Async_Pump();
+}
 
-		for(i=0;i<h;i++) {
-			for(j=0;j<w;j++) {
-				Draw_Pixe(x+j, y+i,color);
-			}
+/*!
+ * @brief Start filling a rectangle, cropped to the display, and return as 
+ *   soon as the first chunk is on the wire.  See Push_Any_Color_Async().
+ * 
+ * @param x The x co-ordinate of the display
+ * @param y The y co-ordinate of the display
+ * 
+ * @param w The width of the rectangle
+ * @param h The height of the rectangle
+ * 
+ * @param color The rgb565 colour to fill the rectangle with
+ */
+void LCDWIKI_SPI::Fill_Rect_Async(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+	uint8_t pixel_bytes = (MODEL == ILI9488_18) ? 3 : 2;
+	uint16_t pixels;
+
+	Wait_Async();
+
+	if(!Clip_Rect(x, y, w, h) || (lcd_driver == ID_1106) || frame_shadow) {
+		// nothing to send (the SH1106 only draws to its RAM buffer, and a 
+		// frame to its shadow canvas)
+		if((lcd_driver == ID_1106) || frame_shadow) {
+			Fill_Rect(x, y, w, h, color);
+		}
+
+		if(async_callback) {
+			async_callback(async_arg);
 		}
-		CS_IDLE;
 		return;
-	} else if(lcd_driver == ID_932X) {
-		writeCmd8(ILI932X_START_OSC);
 	}
 
-	writeCmd8(CC);
+	Set_Addr_Window(x, y, x + w - 1, y + h - 1);
 
-	if (h > w) {
-		end = h;
-		h = w;
-		w = end;
+	CS_ACTIVE;
+	if(lcd_driver == ID_932X) {
+		writeCmd8(ILI932X_START_OSC);
+	}
+	writeCmd8(CC);
+	CD_DATA;
+
+	async_fill = true;
+	async_color = color;
+	async_left = (uint32_t)w * h;
+	async_len = 0;
+	async_which = 0;
+
+	// every chunk of a fill is the same, so the buffer is only encoded once
+	pixels = SPI_ASYNC_CHUNK / pixel_bytes;
+	if(pixels > async_left) {
+		pixels = async_left;
+	}
+	for(uint16_t i = 0; i < pixels; i++) {
+		if(pixel_bytes == 3) {
+			Encode_Color<3>(color, async_buf[0] + i * 3);
+		} else {
+			Encode_Color<2>(color, async_buf[0] + i * 2);
+		}
 	}
 
-	while (h-- > 0)  {
-		end = w;
-		do {
+	async_active = true;
+	Async_Pump();
+}
+
+/*!
+ * @brief Set the function that is called each time an async push finishes.
+ *   It is called from inside Is_Busy() (or from whichever drawing function 
+ *   had to wait for the push), and may start the next async push.
+ *
+ * @param callback The function to call, or NULL for none
+ * @param arg The argument to pass to the callback
+ */
+void LCDWIKI_SPI::Set_Async_Callback(lcd_async_callback callback, void *arg) {
+	async_callback = callback;
+	async_arg = arg;
+}
+
+/*!
+ * @brief Move the async push along, and say whether it is still running.  
+ *   Call this regularly from the main loop while there is a push running.
+ *
+ * @return true whilst there is an async push that has not finished
+ */
+boolean LCDWIKI_SPI::Is_Busy(void) {
+	Async_Pump();
+	return(async_active);
+}
+
+/*!
+ * @brief Get the next chunk of the async push ready and, once the transport 
+ *   is free, send it.  When everything has been sent the chip is released 
+ *   and the callback is called.
+ */
+void LCDWIKI_SPI::Async_Pump(void) {
+	while(async_active) {
+		// fill the free buffer while the other one is still on the wire
+		if(!async_len && async_left) {
 			if(MODEL == ILI9488_18) {
-				writeData18(color);
+				Async_Prepare<3>();
 			} else {
-				writeData16(color);
+				Async_Prepare<2>();
 			}
-		} while (--end != 0);
+		}
+
+		if(bus.Is_Busy()) {
+			return;
+		}
+
+		if(!async_len) {
+			async_active = false;
+
+			if(async_fill) {
+				if(lcd_driver == ID_932X) {
+					Set_Addr_Window(0, 0, width - 1, height - 1);
+				} else if(lcd_driver == ID_7575) {
+					Set_LR();
+				}
+			}
+			CS_IDLE;
+
+			if(async_callback) {
+				async_callback(async_arg);
+			}
+			return;
+		}
+
+		bus.Write_Block_Async(async_buf[async_which], async_len);
+		async_len = 0;
+		if(!async_fill) {
+			async_which = (async_which + 1) % SPI_ASYNC_BUFFERS;
+		}
 	}
+}
 
-	if(lcd_driver == ID_932X) {
-		Set_Addr_Window(0, 0, width - 1, height - 1);
-	} else if(lcd_driver == ID_7575) {
-		Set_LR();
+/*!
+ * @brief Encode the next chunk of the async push into the free buffer, a 
+ *   fill only needs the length as the buffer was encoded at the start.
+ */
+template<uint8_t PIXEL_BYTES>
+void LCDWIKI_SPI::Async_Prepare(void) {
+	uint16_t pixels = SPI_ASYNC_CHUNK / PIXEL_BYTES;
+	uint8_t *dst = async_buf[async_which];
+
+	if(pixels > async_left) {
+		pixels = async_left;
 	}
+	async_left -= pixels;
+	async_len = pixels * PIXEL_BYTES;
 
-	CS_IDLE;
+	if(async_fill) {
+		return;
+	}
+
+	if(!(async_flags & 1)) {
+		Encode_Block<PIXEL_BYTES>(async_src, dst, pixels);
+		async_src += pixels;
+		return;
+	}
+
+	while(pixels--) {
+		Encode_Color<PIXEL_BYTES>(pgm_read_word(async_src++), dst);
+		dst += PIXEL_BYTES;
+	}
 }
 
 /*!
@@ -1304,6 +2923,8 @@ void LCDWIKI_SPI::Vert_Scroll(int16_t top, int16_t scrollines, int16_t offset) {
 	int16_t vsp;
 	int16_t sea = top;
 
+	Invalidate_Addr_Window();
+
 	if(lcd_driver == ID_7735_128) {
 		bfa = HEIGHT - top - scrollines+4; 
 	} else {
@@ -1354,6 +2975,25 @@ void LCDWIKI_SPI::Vert_Scroll(int16_t top, int16_t scrollines, int16_t offset) {
 	}
 }
 
+/*!
+ * @brief Whether Vert_Scroll() scrolls the rows of the screen as it is now,
+ *   between fixed top and bottom areas.  The ILI932x scrolls the whole 
+ *   screen, the SH1106 not at all, and in the other rotations the scroll 
+ *   runs across the screen (or from the bottom up).
+ */
+boolean LCDWIKI_SPI::Can_Vert_Scroll(void) const {
+	return (rotation == 0) && (lcd_driver != ID_932X) && (lcd_driver != ID_1106);
+}
+
+/*!
+ * @brief Get the GRAM row of the top row of the screen, which has to be 
+ *   added to the top and start of a Vert_Scroll() area.  Only the 
+ *   ST7735S128 has one, its 128 rows sit part way down a bigger GRAM.
+ */
+int16_t LCDWIKI_SPI::Get_Scroll_Offset(void) const {
+	return yoffset;
+}
+
 //get lcd width
 int16_t LCDWIKI_SPI::Get_Width(void) const {
 	return width;
@@ -1370,6 +3010,7 @@ void LCDWIKI_SPI::Set_Rotation(uint8_t r) {
 	width = (rotation & 1) ? HEIGHT : WIDTH;
 	height = (rotation & 1) ? WIDTH : HEIGHT;
 
+	Invalidate_Addr_Window();
 	CS_ACTIVE;
 
 	if((lcd_driver == ID_932X)||(lcd_driver == ID_9225)) {
@@ -1558,53 +3199,97 @@ void LCDWIKI_SPI::Invert_Display(boolean i) {
  * @param y The y position to start drawing the bitmap
  * @param width The width of the image
  * @param height The height of the image
- * @param BMP The pointer to the bitmap data (in the correct format for this display)
- * @param mode The mode - at the moment if it is 1 - it will read from PROGMEM, 
- *   otherwise, it will read from memory
- * 
- * @warning This is quite a slow way to draw a bit map as it sets draws 
- *   individual pixels by calling Draw_Pixe()
+ * @param BMP The pointer to the bitmap data in PROGMEM (in the correct format 
+ *   for this display, a byte for 8 rows of each column, a page at a time)
+ * @param mode 1 to draw the bitmap as it is, 0 to draw it inverted
+ *
+ * @note Each source byte is shifted into the one or two pages of the RAM
+ *   buffer that it lands in, whole rows of 8 at a time, so height is 
+ *   rounded up to a multiple of 8 (see LCDWIKI_Mono_Canvas::Bitmap_Op())
  */
 void LCDWIKI_SPI::SH1106_Draw_Bitmap(uint8_t x, uint8_t y, uint8_t width, uint8_t height, uint8_t *BMP, uint8_t mode) {
-	uint8_t i,
-			j,
-			k,
-			tmp;
-
-	for(i = 0; i < (height+7)/8; i++) {
-		for(j = 0; j < width; j++) {
-			if(mode) {
-				tmp = pgm_read_byte(&BMP[i*width+j]);
-			} else {
-				tmp = ~(pgm_read_byte(&BMP[i*width+j]));
-			}
+	if(!SH1106_buffer) {
+		return;
+	}
 
-			for(k=0;k<8;k++) {
-				if(tmp&0x01) {
-					Draw_Pixe(x+j, y+i*8+k,1);
-				} else {
-					Draw_Pixe(x+j, y+i*8+k,0);
-				}
-				tmp>>=1;
-			}
-		}
+	LCDWIKI_Mono_Canvas::Bitmap_Op(SH1106_buffer, WIDTH, 8, x, y, width, height, BMP, mode, 
+			SH1106_dirty_first, SH1106_dirty_last);
+}
+
+/*!
+ * @brief Invert a rectangle of the SH1106 RAM buffer, cropped to the 
+ *   display.  Send it with SH1106_Display().
+ *
+ * @param x The x co-ordinate of the display
+ * @param y The y co-ordinate of the display
+ * @param w The width of the rectangle
+ * @param h The height of the rectangle
+ */
+void LCDWIKI_SPI::SH1106_Invert_Rect(int16_t x, int16_t y, int16_t w, int16_t h) {
+	if((lcd_driver != ID_1106) || !SH1106_buffer || !Clip_Rect(x, y, w, h)) {
+		return;
+	}
+
+	LCDWIKI_Mono_Canvas::Rect_Op(SH1106_buffer, WIDTH, x, y, w, h, MONO_INVERT, SH1106_dirty_first, SH1106_dirty_last);
+}
+
+/*!
+ * @brief Give the SH1106 a RAM buffer of the sketch's own, of 
+ *   WIDTH * HEIGHT / 8 (1024) bytes, in place of the one that it would 
+ *   otherwise allocate when it is initialised.  Call this before Init_LCD().
+ *   The same storage can be shared with a LCDWIKI_Mono_Canvas.
+ *
+ * @param buffer The buffer, or NULL to allocate one at the next Init_LCD()
+ */
+void LCDWIKI_SPI::Set_SH1106_Buffer(uint8_t *buffer) {
+	if(SH1106_allocated) {
+		free(SH1106_buffer);
+		SH1106_allocated = false;
 	}
+
+	SH1106_buffer = buffer;
+	SH1106_Mark_All(WIDTH);
+}
+
+/*!
+ * @brief Get the SH1106 RAM buffer, NULL until there is one
+ */
+uint8_t *LCDWIKI_SPI::Get_SH1106_Buffer(void) const {
+	return SH1106_buffer;
 }
 
+/*!
+ * @brief Send the SH1106 RAM buffer to the display.  Drawing on the SH1106
+ *   only changes the buffer, and only the columns of each page that have 
+ *   changed since the last call are sent.
+ */
 void LCDWIKI_SPI::SH1106_Display(void) {
-	u8 i,n;	
+	u8 i;
+
+	if(!SH1106_buffer) {
+		return;
+	}
+
 	CS_ACTIVE;
 	for(i=0;i<8;i++)  
 	{  
-		writeCmd8(YC+i);    
-		writeCmd8(0x02); 
-		writeCmd8(XC); 
-		for(n=0;n<WIDTH;n++)
-		{
-			writeData8(SH1106_buffer[i*WIDTH+n]); 
+		if(SH1106_dirty_first[i] > SH1106_dirty_last[i]) {
+			continue;
 		}
+
+		// only the columns that have changed, the display RAM starts at 
+		// column 2 (it is 132 wide)
+		u8 col = SH1106_dirty_first[i] + 2;
+
+		writeCmd8(YC+i);    
+		writeCmd8(0x00 | (col & 0x0F)); 
+		writeCmd8(XC | (col >> 4)); 
+		CD_DATA;
+		Spi_Write_Block(&SH1106_buffer[i*WIDTH+SH1106_dirty_first[i]], SH1106_dirty_last[i] - SH1106_dirty_first[i] + 1);
 	} 
 	CS_IDLE;
+
+	SH1106_Mark_Clean();
 }
 
 void LCDWIKI_SPI::init_table8(const void *table, int16_t size) {
@@ -1646,159 +3331,167 @@ void LCDWIKI_SPI:: init_table16(const void *table, int16_t size)
     }
 }
 
-void LCDWIKI_SPI::start(uint16_t ID) {
-	reset();
-	delay(200);
+/*!
+ * @brief Set up the registers for, and initialise the ILI9325 and ILI9328 controllers
+ */
+void LCDWIKI_SPI::init_932x(void) {
+	lcd_driver = ID_932X;
+	//WIDTH = 240,HEIGHT = 320;
+	//width = WIDTH, height = HEIGHT;
+	XC=0,
+	YC=0,
+	CC=ILI932X_RW_GRAM,
+	RC=ILI932X_RW_GRAM,
+	SC1=ILI932X_GATE_SCAN_CTRL2,
+	SC2=ILI932X_GATE_SCAN_CTRL3,
+	MD=0x0003,
+	VL=1,
+	R24BIT=0;
+	static const uint16_t ILI932x_regValues[] PROGMEM =  {
+  		ILI932X_START_OSC 	   , 0x0001, // Start oscillator
+  		TFTLCD_DELAY16			   , 50,	 // 50 millisecond delay
+  		ILI932X_DRIV_OUT_CTRL    , 0x0100,
+  		ILI932X_DRIV_WAV_CTRL    , 0x0700,
+  		ILI932X_ENTRY_MOD 	   , 0x1030,
+  		ILI932X_RESIZE_CTRL	   , 0x0000,
+  		ILI932X_DISP_CTRL2	   , 0x0202,
+  		ILI932X_DISP_CTRL3	   , 0x0000,
+  		ILI932X_DISP_CTRL4	   , 0x0000,
+  		ILI932X_RGB_DISP_IF_CTRL1, 0x0,
+  		ILI932X_FRM_MARKER_POS   , 0x0,
+  		ILI932X_RGB_DISP_IF_CTRL2, 0x0,
+  		ILI932X_POW_CTRL1 	   , 0x0000,
+  		ILI932X_POW_CTRL2 	   , 0x0007,
+  		ILI932X_POW_CTRL3 	   , 0x0000,
+  		ILI932X_POW_CTRL4 	   , 0x0000,
+  		TFTLCD_DELAY16			   , 200,
+  		ILI932X_POW_CTRL1 	   , 0x1690,
+  		ILI932X_POW_CTRL2 	   , 0x0227,
+  		TFTLCD_DELAY16			   , 50,
+  		ILI932X_POW_CTRL3 	   , 0x001A,
+  		TFTLCD_DELAY16			   , 50,
+  		ILI932X_POW_CTRL4 	   , 0x1800,
+  		ILI932X_POW_CTRL7 	   , 0x002A,
+  		TFTLCD_DELAY16			   , 50,
+  		ILI932X_GAMMA_CTRL1	   , 0x0000,
+  		ILI932X_GAMMA_CTRL2	   , 0x0000,
+  		ILI932X_GAMMA_CTRL3	   , 0x0000,
+  		ILI932X_GAMMA_CTRL4	   , 0x0206,
+  		ILI932X_GAMMA_CTRL5	   , 0x0808,
+  		ILI932X_GAMMA_CTRL6	   , 0x0007,
+  		ILI932X_GAMMA_CTRL7	   , 0x0201,
+  		ILI932X_GAMMA_CTRL8	   , 0x0000,
+  		ILI932X_GAMMA_CTRL9	   , 0x0000,
+ 		ILI932X_GAMMA_CTRL10	   , 0x0000,
+  		ILI932X_GRAM_HOR_AD	   , 0x0000,
+  		ILI932X_GRAM_VER_AD	   , 0x0000,
+  		ILI932X_HOR_START_AD	   , 0x0000,
+  		ILI932X_HOR_END_AD	   , 0x00EF,
+  		ILI932X_VER_START_AD	   , 0X0000,
+  		ILI932X_VER_END_AD	   , 0x013F,
+  		ILI932X_GATE_SCAN_CTRL1  , 0xA700, // Driver Output Control (R60h)
+  		ILI932X_GATE_SCAN_CTRL2  , 0x0003, // Driver Output Control (R61h)
+  		ILI932X_GATE_SCAN_CTRL3  , 0x0000, // Driver Output Control (R62h)
+  		ILI932X_PANEL_IF_CTRL1   , 0X0010, // Panel Interface Control 1 (R90h)
+  		ILI932X_PANEL_IF_CTRL2   , 0X0000,
+  		ILI932X_PANEL_IF_CTRL3   , 0X0003,
+  		ILI932X_PANEL_IF_CTRL4   , 0X1100,
+  		ILI932X_PANEL_IF_CTRL5   , 0X0000,
+  		ILI932X_PANEL_IF_CTRL6   , 0X0000,
+  		ILI932X_DISP_CTRL1	   , 0x0133 // Main screen turn on		
+	};
+	init_table16(ILI932x_regValues, sizeof(ILI932x_regValues));
+}
 
-	switch(ID) {
-		case 0x9325:
-		case 0x9328:
-			lcd_driver = ID_932X;
-			//WIDTH = 240,HEIGHT = 320;
-			//width = WIDTH, height = HEIGHT;
-			XC=0,
-			YC=0,
-			CC=ILI932X_RW_GRAM,
-			RC=ILI932X_RW_GRAM,
-			SC1=ILI932X_GATE_SCAN_CTRL2,
-			SC2=ILI932X_GATE_SCAN_CTRL3,
-			MD=0x0003,
-			VL=1,
-			R24BIT=0;
-			static const uint16_t ILI932x_regValues[] PROGMEM =  {
-		  		ILI932X_START_OSC 	   , 0x0001, // Start oscillator
-		  		TFTLCD_DELAY16			   , 50,	 // 50 millisecond delay
-		  		ILI932X_DRIV_OUT_CTRL    , 0x0100,
-		  		ILI932X_DRIV_WAV_CTRL    , 0x0700,
-		  		ILI932X_ENTRY_MOD 	   , 0x1030,
-		  		ILI932X_RESIZE_CTRL	   , 0x0000,
-		  		ILI932X_DISP_CTRL2	   , 0x0202,
-		  		ILI932X_DISP_CTRL3	   , 0x0000,
-		  		ILI932X_DISP_CTRL4	   , 0x0000,
-		  		ILI932X_RGB_DISP_IF_CTRL1, 0x0,
-		  		ILI932X_FRM_MARKER_POS   , 0x0,
-		  		ILI932X_RGB_DISP_IF_CTRL2, 0x0,
-		  		ILI932X_POW_CTRL1 	   , 0x0000,
-		  		ILI932X_POW_CTRL2 	   , 0x0007,
-		  		ILI932X_POW_CTRL3 	   , 0x0000,
-		  		ILI932X_POW_CTRL4 	   , 0x0000,
-		  		TFTLCD_DELAY16			   , 200,
-		  		ILI932X_POW_CTRL1 	   , 0x1690,
-		  		ILI932X_POW_CTRL2 	   , 0x0227,
-		  		TFTLCD_DELAY16			   , 50,
-		  		ILI932X_POW_CTRL3 	   , 0x001A,
-		  		TFTLCD_DELAY16			   , 50,
-		  		ILI932X_POW_CTRL4 	   , 0x1800,
-		  		ILI932X_POW_CTRL7 	   , 0x002A,
-		  		TFTLCD_DELAY16			   , 50,
-		  		ILI932X_GAMMA_CTRL1	   , 0x0000,
-		  		ILI932X_GAMMA_CTRL2	   , 0x0000,
-		  		ILI932X_GAMMA_CTRL3	   , 0x0000,
-		  		ILI932X_GAMMA_CTRL4	   , 0x0206,
-		  		ILI932X_GAMMA_CTRL5	   , 0x0808,
-		  		ILI932X_GAMMA_CTRL6	   , 0x0007,
-		  		ILI932X_GAMMA_CTRL7	   , 0x0201,
-		  		ILI932X_GAMMA_CTRL8	   , 0x0000,
-		  		ILI932X_GAMMA_CTRL9	   , 0x0000,
-		 		ILI932X_GAMMA_CTRL10	   , 0x0000,
-		  		ILI932X_GRAM_HOR_AD	   , 0x0000,
-		  		ILI932X_GRAM_VER_AD	   , 0x0000,
-		  		ILI932X_HOR_START_AD	   , 0x0000,
-		  		ILI932X_HOR_END_AD	   , 0x00EF,
-		  		ILI932X_VER_START_AD	   , 0X0000,
-		  		ILI932X_VER_END_AD	   , 0x013F,
-		  		ILI932X_GATE_SCAN_CTRL1  , 0xA700, // Driver Output Control (R60h)
-		  		ILI932X_GATE_SCAN_CTRL2  , 0x0003, // Driver Output Control (R61h)
-		  		ILI932X_GATE_SCAN_CTRL3  , 0x0000, // Driver Output Control (R62h)
-		  		ILI932X_PANEL_IF_CTRL1   , 0X0010, // Panel Interface Control 1 (R90h)
-		  		ILI932X_PANEL_IF_CTRL2   , 0X0000,
-		  		ILI932X_PANEL_IF_CTRL3   , 0X0003,
-		  		ILI932X_PANEL_IF_CTRL4   , 0X1100,
-		  		ILI932X_PANEL_IF_CTRL5   , 0X0000,
-		  		ILI932X_PANEL_IF_CTRL6   , 0X0000,
-		  		ILI932X_DISP_CTRL1	   , 0x0133 // Main screen turn on		
-			};
-			init_table16(ILI932x_regValues, sizeof(ILI932x_regValues));
-			break;
-		case 0x9341:
-			lcd_driver = ID_9341;
-			//WIDTH = 240,HEIGHT = 320;
-			//width = WIDTH, height = HEIGHT;
-			XC=ILI9341_COLADDRSET,YC=ILI9341_PAGEADDRSET,CC=ILI9341_MEMORYWRITE,RC=HX8357_RAMRD,SC1=0x33,SC2=0x37,MD=ILI9341_MADCTL,VL=0,R24BIT=1;
-			static const uint8_t ILI9341_regValues[] PROGMEM =  {        // BOE 2.4"
-				ILI9341_SOFTRESET,0,                 //Soft Reset
-				TFTLCD_DELAY8, 50, 
-				ILI9341_DISPLAYOFF, 0,            //Display Off
-			//	ILI9341_PIXELFORMAT, 1, 0x55,      //Pixel read=565, write=565.
-				ILI9341_INTERFACECONTROL, 3, 0x01, 0x01, 0x00,  //Interface Control needs EXTC=1 MV_EOR=0, TM=0, RIM=0
-				ILI9341_POWERCONTROLB, 3, 0x00, 0x81, 0x30,  //Power Control B [00 81 30]
-				ILI9341_POWERONSEQ, 4, 0x64, 0x03, 0x12, 0x81,    //Power On Seq [55 01 23 01]
-				ILI9341_DRIVERTIMINGA, 3, 0x85, 0x10, 0x78,  //Driver Timing A [04 11 7A]
-				ILI9341_POWERCONTROLA, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,      //Power Control A [39 2C 00 34 02]
-				ILI9341_RUMPRATIO, 1, 0x20,      //Pump Ratio [10]
-				ILI9341_DRIVERTIMINGB, 2, 0x00, 0x00,        //Driver Timing B [66 00]
-				ILI9341_RGBSIGNAL, 1, 0x00,      //RGB Signal [00] 
-			//	ILI9341_FRAMECONTROL, 2, 0x00, 0x1B,        //Frame Control [00 1B]
-				//            0xB6, 2, 0x0A, 0xA2, 0x27, //Display Function [0A 82 27 XX]    .kbv SS=1  
-				ILI9341_INVERSIONCONRTOL, 1, 0x00,      //Inversion Control [02] .kbv NLA=1, NLB=1, NLC=1
-				ILI9341_POWERCONTROL1, 1, 0x21,      //Power Control 1 [26]
-				ILI9341_POWERCONTROL2, 1, 0x11,      //Power Control 2 [00]
-				ILI9341_VCOMCONTROL1, 2, 0x3F, 0x3C,        //VCOM 1 [31 3C]
-				ILI9341_VCOMCONTROL2, 1, 0xB5,      //VCOM 2 [C0]
-				ILI9341_MEMCONTROL, 1, ILI9341_MADCTL_MY | ILI9341_MADCTL_BGR,
-				ILI9341_PIXELFORMAT, 1, 0x55,      //Pixel read=565, write=565.
-				ILI9341_FRAMECONTROL, 2, 0x00, 0x1B,        //Frame Control [00 1B]
-				ILI9341_MEMORYACCESS, 1, 0x48,      //Memory Access [00]
-				ILI9341_ENABLE3G, 1, 0x00,      //Enable 3G [02]
-				ILI9341_GAMMASET, 1, 0x01,      //Gamma Set [01]
-				ILI9341_UNDEFINE0, 15, 0x0f, 0x26, 0x24, 0x0b, 0x0e, 0x09, 0x54, 0xa8, 0x46, 0x0c, 0x17, 0x09, 0x0f, 0x07, 0x00,
-				ILI9341_UNDEFINE1, 15, 0x00, 0x19, 0x1b, 0x04, 0x10, 0x07, 0x2a, 0x47, 0x39, 0x03, 0x06, 0x06, 0x30, 0x38, 0x0f,
-				ILI9341_ENTRYMODE, 1,0x07,
-				ILI9341_SLEEPOUT, 0,            //Sleep Out
-				TFTLCD_DELAY8, 150,
-				ILI9341_DISPLAYON, 0          //Display On
-			};
-			init_table8(ILI9341_regValues, sizeof(ILI9341_regValues));    
-			break;
-		case 0x9090:
-			lcd_driver = ID_HX8357D;
-			//WIDTH = 320,HEIGHT = 480;
-			//width = WIDTH, height = HEIGHT;
-			XC=ILI9341_COLADDRSET,YC=ILI9341_PAGEADDRSET,CC=HX8357_RAMWR,RC=HX8357_RAMRD,SC1=0x33,SC2=0x37,MD=HX8357_MADCTL,VL=1,R24BIT=1;
-			static const uint8_t HX8357D_regValues[] PROGMEM = {
-				HX8357_SWRESET, 0,
-				HX8357D_SETC, 3, 0xFF, 0x83, 0x57,
-				TFTLCD_DELAY8, 250,
-				HX8357_SETRGB, 4, 0x00, 0x00, 0x06, 0x06,
-				HX8357D_SETCOM, 1, 0x25,  // -1.52V
-				HX8357_SETOSC, 1, 0x68,  // Normal mode 70Hz, Idle mode 55 Hz
-				HX8357_SETPANEL, 1, 0x05,  // BGR, Gate direction swapped
-				HX8357_SETPWR1, 6, 0x00, 0x15, 0x1C, 0x1C, 0x83, 0xAA,
-				HX8357D_SETSTBA, 6, 0x50, 0x50, 0x01, 0x3C, 0x1E, 0x08,
-				// MEME GAMMA HERE
-				HX8357D_SETCYC, 7, 0x02, 0x40, 0x00, 0x2A, 0x2A, 0x0D, 0x78,
-				HX8357_COLMOD, 1, 0x55,
-				HX8357_MADCTL, 1, 0xC0,
-				HX8357_TEON, 1, 0x00,
-				HX8357_TEARLINE, 2, 0x00, 0x02,
-				HX8357_SLPOUT, 0,
-				TFTLCD_DELAY8, 150,
-				HX8357_DISPON, 0, 
-				TFTLCD_DELAY8, 50
-			};
-			init_table8(HX8357D_regValues, sizeof(HX8357D_regValues));
-			break;
-		case 0x7575:
-		case 0x9595:
-			lcd_driver = ID_7575;
-			//WIDTH = 240,HEIGHT = 320;
-			//width = WIDTH, height = HEIGHT;
-			XC=0,YC=0,CC=0x22,RC=ILI932X_RW_GRAM,SC1=0x0E,SC2=0x14,MD=HX8347G_MEMACCESS,VL=1,R24BIT=1;
-			static const uint8_t HX8347G_regValues[] PROGMEM = 
-			{
-				//  0xEA, 2, 0x00, 0x20,        //PTBA[15:0]
+/*!
+ * @brief Set up the registers for, and initialise the ILI9341 controller
+ */
+void LCDWIKI_SPI::init_9341(void) {
+	lcd_driver = ID_9341;
+	//WIDTH = 240,HEIGHT = 320;
+	//width = WIDTH, height = HEIGHT;
+	XC=ILI9341_COLADDRSET,YC=ILI9341_PAGEADDRSET,CC=ILI9341_MEMORYWRITE,RC=HX8357_RAMRD,SC1=0x33,SC2=0x37,MD=ILI9341_MADCTL,VL=0,R24BIT=1;
+	static const uint8_t ILI9341_regValues[] PROGMEM =  {        // BOE 2.4"
+		ILI9341_SOFTRESET,0,                 //Soft Reset
+		TFTLCD_DELAY8, 50, 
+		ILI9341_DISPLAYOFF, 0,            //Display Off
+	//	ILI9341_PIXELFORMAT, 1, 0x55,      //Pixel read=565, write=565.
+		ILI9341_INTERFACECONTROL, 3, 0x01, 0x01, 0x00,  //Interface Control needs EXTC=1 MV_EOR=0, TM=0, RIM=0
+		ILI9341_POWERCONTROLB, 3, 0x00, 0x81, 0x30,  //Power Control B [00 81 30]
+		ILI9341_POWERONSEQ, 4, 0x64, 0x03, 0x12, 0x81,    //Power On Seq [55 01 23 01]
+		ILI9341_DRIVERTIMINGA, 3, 0x85, 0x10, 0x78,  //Driver Timing A [04 11 7A]
+		ILI9341_POWERCONTROLA, 5, 0x39, 0x2C, 0x00, 0x34, 0x02,      //Power Control A [39 2C 00 34 02]
+		ILI9341_RUMPRATIO, 1, 0x20,      //Pump Ratio [10]
+		ILI9341_DRIVERTIMINGB, 2, 0x00, 0x00,        //Driver Timing B [66 00]
+		ILI9341_RGBSIGNAL, 1, 0x00,      //RGB Signal [00] 
+	//	ILI9341_FRAMECONTROL, 2, 0x00, 0x1B,        //Frame Control [00 1B]
+		//            0xB6, 2, 0x0A, 0xA2, 0x27, //Display Function [0A 82 27 XX]    .kbv SS=1  
+		ILI9341_INVERSIONCONRTOL, 1, 0x00,      //Inversion Control [02] .kbv NLA=1, NLB=1, NLC=1
+		ILI9341_POWERCONTROL1, 1, 0x21,      //Power Control 1 [26]
+		ILI9341_POWERCONTROL2, 1, 0x11,      //Power Control 2 [00]
+		ILI9341_VCOMCONTROL1, 2, 0x3F, 0x3C,        //VCOM 1 [31 3C]
+		ILI9341_VCOMCONTROL2, 1, 0xB5,      //VCOM 2 [C0]
+		ILI9341_MEMCONTROL, 1, ILI9341_MADCTL_MY | ILI9341_MADCTL_BGR,
+		ILI9341_PIXELFORMAT, 1, 0x55,      //Pixel read=565, write=565.
+		ILI9341_FRAMECONTROL, 2, 0x00, 0x1B,        //Frame Control [00 1B]
+		ILI9341_MEMORYACCESS, 1, 0x48,      //Memory Access [00]
+		ILI9341_ENABLE3G, 1, 0x00,      //Enable 3G [02]
+		ILI9341_GAMMASET, 1, 0x01,      //Gamma Set [01]
+		ILI9341_UNDEFINE0, 15, 0x0f, 0x26, 0x24, 0x0b, 0x0e, 0x09, 0x54, 0xa8, 0x46, 0x0c, 0x17, 0x09, 0x0f, 0x07, 0x00,
+		ILI9341_UNDEFINE1, 15, 0x00, 0x19, 0x1b, 0x04, 0x10, 0x07, 0x2a, 0x47, 0x39, 0x03, 0x06, 0x06, 0x30, 0x38, 0x0f,
+		ILI9341_ENTRYMODE, 1,0x07,
+		ILI9341_SLEEPOUT, 0,            //Sleep Out
+		TFTLCD_DELAY8, 150,
+		ILI9341_DISPLAYON, 0          //Display On
+	};
+	init_table8(ILI9341_regValues, sizeof(ILI9341_regValues));
+}
+
+/*!
+ * @brief Set up the registers for, and initialise the HX8357D controller
+ */
+void LCDWIKI_SPI::init_hx8357d(void) {
+	lcd_driver = ID_HX8357D;
+	//WIDTH = 320,HEIGHT = 480;
+	//width = WIDTH, height = HEIGHT;
+	XC=ILI9341_COLADDRSET,YC=ILI9341_PAGEADDRSET,CC=HX8357_RAMWR,RC=HX8357_RAMRD,SC1=0x33,SC2=0x37,MD=HX8357_MADCTL,VL=1,R24BIT=1;
+	static const uint8_t HX8357D_regValues[] PROGMEM = {
+		HX8357_SWRESET, 0,
+		HX8357D_SETC, 3, 0xFF, 0x83, 0x57,
+		TFTLCD_DELAY8, 250,
+		HX8357_SETRGB, 4, 0x00, 0x00, 0x06, 0x06,
+		HX8357D_SETCOM, 1, 0x25,  // -1.52V
+		HX8357_SETOSC, 1, 0x68,  // Normal mode 70Hz, Idle mode 55 Hz
+		HX8357_SETPANEL, 1, 0x05,  // BGR, Gate direction swapped
+		HX8357_SETPWR1, 6, 0x00, 0x15, 0x1C, 0x1C, 0x83, 0xAA,
+		HX8357D_SETSTBA, 6, 0x50, 0x50, 0x01, 0x3C, 0x1E, 0x08,
+		// MEME GAMMA HERE
+		HX8357D_SETCYC, 7, 0x02, 0x40, 0x00, 0x2A, 0x2A, 0x0D, 0x78,
+		HX8357_COLMOD, 1, 0x55,
+		HX8357_MADCTL, 1, 0xC0,
+		HX8357_TEON, 1, 0x00,
+		HX8357_TEARLINE, 2, 0x00, 0x02,
+		HX8357_SLPOUT, 0,
+		TFTLCD_DELAY8, 150,
+		HX8357_DISPON, 0, 
+		TFTLCD_DELAY8, 50
+	};
+	init_table8(HX8357D_regValues, sizeof(HX8357D_regValues));
+}
+
+/*!
+ * @brief Set up the registers for, and initialise the HX8347G and HX8347I controllers
+ */
+void LCDWIKI_SPI::init_7575(void) {
+	lcd_driver = ID_7575;
+	//WIDTH = 240,HEIGHT = 320;
+	//width = WIDTH, height = HEIGHT;
+	XC=0,YC=0,CC=0x22,RC=ILI932X_RW_GRAM,SC1=0x0E,SC2=0x14,MD=HX8347G_MEMACCESS,VL=1,R24BIT=1;
+	static const uint8_t HX8347G_regValues[] PROGMEM = 
+	{
+		//  0xEA, 2, 0x00, 0x20,        //PTBA[15:0]
                //   0xEC, 2, 0x0C, 0xC4,   //
-				  0x2E , 1 , 0x89,
+		  0x2E , 1 , 0x89,
         		  0x29 , 1 , 0x8F,
         		  0x2B , 1 , 0x02,
         		  0xE2 , 1 , 0x00,
@@ -1815,7 +3508,7 @@ void LCDWIKI_SPI::start(uint16_t ID) {
         		  0xE9 , 1 , 0x38, //0x38
         		  0xF1 , 1 , 0x01,
 
-				 // 0x40, 13, 0x01, 0x00, 0x00, 0x10, 0x0E, 0x24, 0x04, 0x50, 0x02, 0x13, 0x19, 0x19, 0x16,  //
+		 // 0x40, 13, 0x01, 0x00, 0x00, 0x10, 0x0E, 0x24, 0x04, 0x50, 0x02, 0x13, 0x19, 0x19, 0x16,  //
             	  //0x50, 14, 0x1B, 0x31, 0x2F, 0x3F, 0x3F, 0x3E, 0x2F, 0x7B, 0x09, 0x06, 0x06, 0x0C, 0x1D, 0xCC,  //
         
         		  // skip gamma, do later
@@ -1849,34 +3542,38 @@ void LCDWIKI_SPI::start(uint16_t ID) {
         		  0x07 , 1 , 0x00,
         		  0x08 , 1 , 0x01,
         		  0x09 , 1 , 0x3F
-			};
-		    init_table8(HX8347G_regValues, sizeof(HX8347G_regValues));
-			break;
-		case 0x9486:
-			lcd_driver = ID_9486;
-			//WIDTH = 320,HEIGHT = 480;
-			//width = WIDTH, height = HEIGHT;
-			XC=ILI9341_COLADDRSET,YC=ILI9341_PAGEADDRSET,CC=ILI9341_MEMORYWRITE,RC=HX8357_RAMRD,SC1=0x33,SC2=0x37,MD=ILI9341_MADCTL,VL=0,R24BIT=0;
-			static const uint8_t ILI9486_regValues[] PROGMEM = 
-			{
-			    0xF1, 6, 0x36, 0x04, 0x00, 0x3C, 0x0F, 0x8F,
-				0xF2, 9, 0x18, 0xA3, 0x12, 0x02, 0xB2, 0x12, 0xFF, 0x10, 0x00, 
-				0xF8, 2, 0x21, 0x04,
-				0xF9, 2, 0x00, 0x08,
-				0x36, 1, 0x08, 
-				0xB4, 1, 0x00,
-				0xC1, 1, 0x41,
-				0xC5, 4, 0x00, 0x91, 0x80, 0x00,
-				0xE0, 15, 0x0F, 0x1F, 0x1C, 0x0C, 0x0F, 0x08, 0x48, 0x98, 0x37, 0x0A, 0x13, 0x04, 0x11, 0x0D, 0x00,
-				0xE1, 15, 0x0F, 0x32, 0x2E, 0x0B, 0x0D, 0x05, 0x47, 0x75, 0x37, 0x06, 0x10 ,0x03, 0x24, 0x20, 0x00,				
-				0x3A, 1, 0x55,
-				0x11,0,
-				0x36, 1, 0x28,
-				TFTLCD_DELAY8, 120,
-				0x29,0
-				
-			/*
-				0x01, 0,            //Soft Reset
+	};
+    init_table8(HX8347G_regValues, sizeof(HX8347G_regValues));
+}
+
+/*!
+ * @brief Set up the registers for, and initialise the ILI9486 controller
+ */
+void LCDWIKI_SPI::init_9486(void) {
+	lcd_driver = ID_9486;
+	//WIDTH = 320,HEIGHT = 480;
+	//width = WIDTH, height = HEIGHT;
+	XC=ILI9341_COLADDRSET,YC=ILI9341_PAGEADDRSET,CC=ILI9341_MEMORYWRITE,RC=HX8357_RAMRD,SC1=0x33,SC2=0x37,MD=ILI9341_MADCTL,VL=0,R24BIT=0;
+	static const uint8_t ILI9486_regValues[] PROGMEM = 
+	{
+	    0xF1, 6, 0x36, 0x04, 0x00, 0x3C, 0x0F, 0x8F,
+		0xF2, 9, 0x18, 0xA3, 0x12, 0x02, 0xB2, 0x12, 0xFF, 0x10, 0x00, 
+		0xF8, 2, 0x21, 0x04,
+		0xF9, 2, 0x00, 0x08,
+		0x36, 1, 0x08, 
+		0xB4, 1, 0x00,
+		0xC1, 1, 0x41,
+		0xC5, 4, 0x00, 0x91, 0x80, 0x00,
+		0xE0, 15, 0x0F, 0x1F, 0x1C, 0x0C, 0x0F, 0x08, 0x48, 0x98, 0x37, 0x0A, 0x13, 0x04, 0x11, 0x0D, 0x00,
+		0xE1, 15, 0x0F, 0x32, 0x2E, 0x0B, 0x0D, 0x05, 0x47, 0x75, 0x37, 0x06, 0x10 ,0x03, 0x24, 0x20, 0x00,				
+		0x3A, 1, 0x55,
+		0x11,0,
+		0x36, 1, 0x28,
+		TFTLCD_DELAY8, 120,
+		0x29,0
+		
+	/*
+		0x01, 0,            //Soft Reset
             	TFTLCD_DELAY8, 150,  // .kbv will power up with ONLY reset, sleep out, display on
             	0x28, 0,            //Display Off
             	0x3A, 1, 0x55,      //Pixel read=565, write=565.
@@ -1892,259 +3589,334 @@ void LCDWIKI_SPI::start(uint16_t ID) {
             	TFTLCD_DELAY8, 150,
             	0x29, 0         //Display On
             */
-			};
-			init_table8(ILI9486_regValues, sizeof(ILI9486_regValues));
+	};
+	init_table8(ILI9486_regValues, sizeof(ILI9486_regValues));
+}
+
+/*!
+ * @brief Set up the registers for, and initialise the ILI9488 (in either 16 or 18 bit colour) controller
+ */
+void LCDWIKI_SPI::init_9488(void) {
+	lcd_driver = ID_9488;			
+	if(MODEL == ILI9488_18)
+	{
+		static const uint8_t ILI9488_IPF[] PROGMEM ={0x3A,1,0x66};
+		init_table8(ILI9488_IPF, sizeof(ILI9488_IPF));
+	}
+	else
+	{
+		static const uint8_t ILI9488_IPF[] PROGMEM ={0x3A,1,0x55};
+		init_table8(ILI9488_IPF, sizeof(ILI9488_IPF));
+	}
+	//WIDTH = 320,HEIGHT = 480;
+	//width = WIDTH, height = HEIGHT;
+	XC=ILI9341_COLADDRSET,YC=ILI9341_PAGEADDRSET,CC=ILI9341_MEMORYWRITE,RC=HX8357_RAMRD,SC1=0x33,SC2=0x37,MD=ILI9341_MADCTL,VL=0,R24BIT=1;
+	static const uint8_t ILI9488_regValues[] PROGMEM = 
+	{
+		0xF7, 4, 0xA9, 0x51, 0x2C, 0x82,
+		0xC0, 2, 0x11, 0x09,
+		0xC1, 1, 0x41,
+		0xC5, 3, 0x00, 0x0A, 0x80,
+		0xB1, 2, 0xB0, 0x11,
+		0xB4, 1, 0x02,
+		0xB6, 2, 0x02, 0x22,
+		0xB7, 1, 0xC6,
+		0xBE, 2, 0x00, 0x04,
+		0xE9, 1, 0x00,
+		0x36, 1, 0x08,
+		0xE0, 15, 0x00, 0x07, 0x10, 0x09, 0x17, 0x0B, 0x41, 0x89, 0x4B, 0x0A, 0x0C, 0x0E, 0x18, 0x1B, 0x0F,
+		0xE1, 15, 0x00, 0x17, 0x1A, 0x04, 0x0E, 0x06, 0x2F, 0x45, 0x43, 0x02, 0x0A, 0x09, 0x32, 0x36, 0x0F,
+		0x11, 0,
+		TFTLCD_DELAY8, 120,
+		0x29, 0
+	};
+	init_table8(ILI9488_regValues, sizeof(ILI9488_regValues));
+}
+
+/*!
+ * @brief Set up the registers for, and initialise the ILI9225 controller
+ */
+void LCDWIKI_SPI::init_9225(void) {
+	lcd_driver = ID_9225;
+	//WIDTH = 176,HEIGHT = 220;
+	//width = WIDTH, height = HEIGHT;
+	XC=0x20,YC=0x21,CC=0x22,RC=0x22,SC1=0x31,SC2=0x33,MD=0x03,VL=1,R24BIT=0;
+	static const uint16_t ILI9225_regValues[] PROGMEM = 
+	{
+		0x01, 0x011C,
+		0x02, 0x0100,	
+		0x03, 0x1030,
+		0x08, 0x0808, // set BP and FP
+		0x0B, 0x1100, // frame cycle
+		0x0C, 0x0000, // RGB interface setting R0Ch=0x0110 for RGB 18Bit and R0Ch=0111for RGB16Bit
+		0x0F, 0x1401, // Set frame rate----0801
+		0x15, 0x0000, // set system interface
+		0x20, 0x0000, // Set GRAM Address
+		0x21, 0x0000, // Set GRAM Address
+		//*************Power On sequence ****************//
+		TFTLCD_DELAY16, 50, // delay 50ms
+		0x10, 0x0800, // Set SAP,DSTB,STB----0A00
+		0x11, 0x1F3F, // Set APON,PON,AON,VCI1EN,VC----1038
+		TFTLCD_DELAY16, 50, // delay 50ms
+		0x12, 0x0121, // Internal reference voltage= Vci;----1121
+		0x13, 0x006F, // Set GVDD----0066
+		0x14, 0x4349, // Set VCOMH/VCOML voltage----5F60
+		//-------------- Set GRAM area -----------------//
+		0x30, 0x0000,
+		0x31, 0x00DB,
+		0x32, 0x0000,
+		0x33, 0x0000,
+		0x34, 0x00DB,
+		0x35, 0x0000,
+		0x36, 0x00AF,
+		0x37, 0x0000,
+		0x38, 0x00DB,
+		0x39, 0x0000,
+		// ----------- Adjust the Gamma Curve ----------//
+		0x50, 0x0001, // 0x0400
+		0x51, 0x200B, // 0x060B
+		0x52, 0x0000, // 0x0C0A
+		0x53, 0x0404, // 0x0105
+		0x54, 0x0C0C, // 0x0A0C
+		0x55, 0x000C, // 0x0B06
+		0x56, 0x0101, // 0x0004
+		0x57, 0x0400, // 0x0501
+		0x58, 0x1108, // 0x0E00
+		0x59, 0x050C, // 0x000E
+		TFTLCD_DELAY16, 50, // delay 50ms
+		0x07, 0x1017,
+		//0x22, 0x0000,
+	};
+	init_table16(ILI9225_regValues, sizeof(ILI9225_regValues));
+}
+
+/*!
+ * @brief Set up the registers for, and initialise the ST7735S (both the 128x160 and 128x128 versions) controllers
+ */
+void LCDWIKI_SPI::init_7735(void) {
+	if(HEIGHT == 160)
+	{
+		lcd_driver = ID_7735;
+	}
+	else if(HEIGHT == 128)
+	{
+		lcd_driver = ID_7735_128;
+	}
+	//WIDTH = 128,HEIGHT = 160;
+	//width = WIDTH, height = HEIGHT;
+	XC=ILI9341_COLADDRSET,YC=ILI9341_PAGEADDRSET,CC=ILI9341_MEMORYWRITE,RC=HX8357_RAMRD,SC1=0x33,SC2=0x37,MD=ILI9341_MADCTL,VL=0,R24BIT=0;
+	static const uint8_t ST7735S_regValues[] PROGMEM = {
+		0x11, 0,
+		TFTLCD_DELAY8, 120,
+		0xB1, 3, 0x05, 0x3C, 0x3C,
+		0xB2, 3, 0x05, 0x3C, 0x3C,
+		0xB3, 6, 0x05, 0x3C, 0x3C, 0x05, 0x3C, 0x3C,
+		0xB4, 1, 0x03,
+		0xC0, 3, 0x28, 0x08, 0x04,
+		0xC1, 1, 0xC0,
+		0xC2, 2, 0x0D, 0x00,
+		0xC3, 2, 0x8D, 0x2A,
+		0xC4, 2, 0x8D, 0xEE,
+		0xC5, 1, 0x1A,
+		0x17 , 1 , 0x05,
+		0x36, 1, 0x08,
+		0xE0, 16,0x03, 0x22, 0x07, 0x0A, 0x2E, 0x30, 0x25, 0x2A, 0x28, 0x26, 0x2E, 0x3A, 0x00, 0x01, 0x03, 0x13,
+		0xE1, 16,0x04, 0x16, 0x06, 0x0D, 0x2D, 0x26, 0x23, 0x27, 0x27, 0x25, 0x2D, 0x3B, 0x00, 0x01, 0x04, 0x13,         
+		//TFTLCD_DELAY8, 150,
+		0x3A, 1, 0x05,
+		0x29, 0
+	};
+	init_table8(ST7735S_regValues, sizeof(ST7735S_regValues));
+}
+
+/*!
+ * @brief Set up the registers for, and initialise the SSD1283A controller
+ */
+void LCDWIKI_SPI::init_1283a(void) {
+ 	lcd_driver = ID_1283A;
+
+	XC=0x45,
+	YC=0x44,
+	CC=0x22,
+	RC=HX8357_RAMRD,
+	SC1=0x41,
+	SC2=0x42,
+	MD=0x03,
+	VL=1,
+	R24BIT=0;
+
+ 	static const uint16_t SSD1283A_regValues[] PROGMEM =  {
+		0x10, 0x2F8E,
+		0x11, 0x000C,
+		0x07, 0x0021,
+		0x28, 0x0006,
+		0x28, 0x0005,
+		0x27, 0x057F,
+		0x29, 0x89A1,
+		0x00, 0x0001,
+		TFTLCD_DELAY16, 100,
+		0x29, 0x80B0,
+		TFTLCD_DELAY16, 30, 
+		0x29, 0xFFFE,
+		0x07, 0x0223,
+		TFTLCD_DELAY16, 30, 
+		0x07, 0x0233,
+		0x01, 0x2183,
+		0x03, 0x6830,
+		0x2F, 0xFFFF,
+		0x2C, 0x8000,
+		0x27, 0x0570,
+		0x02, 0x0300,
+		0x0B, 0x580C,
+		0x12, 0x0609,
+		0x13, 0x3100, 
+	};
+	init_table16(SSD1283A_regValues, sizeof(SSD1283A_regValues));
+}
+
+/*!
+ * @brief Set up the registers for, and initialise the ST7796S controller
+ */
+void LCDWIKI_SPI::init_7796(void) {
+	lcd_driver = ID_7796;
+	XC=ILI9341_COLADDRSET, // 0x2A
+	YC=ILI9341_PAGEADDRSET, // 0x2B
+	CC=ILI9341_MEMORYWRITE, // 0x2C
+	RC=HX8357_RAMRD, // 0x2E
+	SC1=0x33, // Vertical scrolling definition
+	SC2=0x37, // Vertical scrolling start address of RAM
+	MD=ILI9341_MADCTL, // 0x36 - Memory Data Access Contro
+	VL=0, // This is to do with the display inversion control
+	R24BIT=1; // this is about reading the colour from the display in 24 bit or 16 bit
+
+	static const uint8_t ST7796S_regValues[] PROGMEM = {
+		0xF0, 1, 0xC3,
+		0xF0, 1, 0x96, 
+		0x36, 1, 0x68,
+		0x3A, 1, 0x05,
+		0xB0, 1, 0x80, 
+		0xB6, 2, 0x00, 0x02,
+		0xB5, 4, 0x02, 0x03, 0x00, 0x04,
+		0xB1, 2, 0x80, 0x10, 
+		0xB4, 1, 0x00,
+		0xB7, 1, 0xC6,
+		0xC5, 1, 0x24,
+		0xE4, 1, 0x31,
+		0xE8, 8, 0x40, 0x8A, 0x00, 0x00, 0x29, 0x19, 0xA5, 0x33,
+		0xC2, 0,
+		0xA7, 0,
+		0xE0, 14, 0xF0, 0x09, 0x13, 0x12, 0x12, 0x2B, 0x3C, 0x44, 0x4B, 0x1B, 0x18, 0x17, 0x1D, 0x21,
+		0xE1, 14, 0xF0, 0x09, 0x13, 0x0C, 0x0D, 0x27, 0x3B, 0x44, 0x4D, 0x0B, 0x17 ,0x17, 0x1D, 0x21,				
+		0x36, 1, 0x48,
+		0xF0, 1, 0xC3,
+		0xF0, 1, 0x69, 
+		0x13, 0,
+		0x11, 0,
+		0x29, 0,
+	};
+	init_table8(ST7796S_regValues, sizeof(ST7796S_regValues));
+}
+
+/*!
+ * @brief Set up the registers for, and initialise the SH1106 controller
+ */
+void LCDWIKI_SPI::init_1106(void) {
+ 	lcd_driver = ID_1106;
+
+	// the RAM buffer is only needed on the SH1106, so it is not allocated
+	// until now (unless the sketch has supplied one)
+	if(!SH1106_buffer) {
+		SH1106_buffer = (uint8_t *)calloc(WIDTH * (HEIGHT / 8), 1);
+		SH1106_allocated = (SH1106_buffer != NULL);
+	}
+
+	// the display RAM is unknown, so the first SH1106_Display() sends it all
+	SH1106_Mark_All(WIDTH);
+
+	XC=0x10,
+	YC=0xB0,
+	CC=0,
+	RC=0,
+	SC1=0,
+	SC2=0,
+	MD=0,
+	VL=1,
+	R24BIT=0;
+
+	static const uint8_t SH1106_regValues[] PROGMEM =  {
+		0x8D, 0,
+		0x10, 0,
+		0xAE, 0,
+		0x02, 0,
+		0x10, 0,
+		0x40, 0,
+		0x81, 0,
+		0xCF, 0,
+		0xA1, 0,
+		0xC8, 0,
+		0xA6, 0,
+		0xA8, 0,
+		0x3F, 0,
+		0xD3, 0,
+		0x00, 0,
+		0xD5, 0,
+		0x80, 0,
+		0xD9, 0,
+		0xF1, 0,
+		0xDA, 0,
+		0x12, 0,
+		0xDB, 0,
+		0x40, 0,
+		0x20, 0,
+		0x02, 0,
+		0x8D, 0,
+		0x14, 0,
+		0xA4, 0,
+		0xA6, 0,
+		0xAF, 0,
+	};
+	init_table8(SH1106_regValues, sizeof(SH1106_regValues));
+}
+
+void LCDWIKI_SPI::start(uint16_t ID) {
+	reset();
+	delay(200);
+
+	switch(ID) {
+		case 0x9325:
+		case 0x9328:
+			init_932x();
+			break;
+		case 0x9341:
+			init_9341();
+			break;
+		case 0x9090:
+			init_hx8357d();
+			break;
+		case 0x7575:
+		case 0x9595:
+			init_7575();
+			break;
+		case 0x9486:
+			init_9486();
 			break;
 		case 0x9488:
-			lcd_driver = ID_9488;			
-			if(MODEL == ILI9488_18)
-			{
-				static const uint8_t ILI9488_IPF[] PROGMEM ={0x3A,1,0x66};
-				init_table8(ILI9488_IPF, sizeof(ILI9488_IPF));
-			}
-			else
-			{
-				static const uint8_t ILI9488_IPF[] PROGMEM ={0x3A,1,0x55};
-				init_table8(ILI9488_IPF, sizeof(ILI9488_IPF));
-			}
-			//WIDTH = 320,HEIGHT = 480;
-			//width = WIDTH, height = HEIGHT;
-			XC=ILI9341_COLADDRSET,YC=ILI9341_PAGEADDRSET,CC=ILI9341_MEMORYWRITE,RC=HX8357_RAMRD,SC1=0x33,SC2=0x37,MD=ILI9341_MADCTL,VL=0,R24BIT=1;
-			static const uint8_t ILI9488_regValues[] PROGMEM = 
-			{
-				0xF7, 4, 0xA9, 0x51, 0x2C, 0x82,
-				0xC0, 2, 0x11, 0x09,
-				0xC1, 1, 0x41,
-				0xC5, 3, 0x00, 0x0A, 0x80,
-				0xB1, 2, 0xB0, 0x11,
-				0xB4, 1, 0x02,
-				0xB6, 2, 0x02, 0x22,
-				0xB7, 1, 0xC6,
-				0xBE, 2, 0x00, 0x04,
-				0xE9, 1, 0x00,
-				0x36, 1, 0x08,
-				0xE0, 15, 0x00, 0x07, 0x10, 0x09, 0x17, 0x0B, 0x41, 0x89, 0x4B, 0x0A, 0x0C, 0x0E, 0x18, 0x1B, 0x0F,
-				0xE1, 15, 0x00, 0x17, 0x1A, 0x04, 0x0E, 0x06, 0x2F, 0x45, 0x43, 0x02, 0x0A, 0x09, 0x32, 0x36, 0x0F,
-				0x11, 0,
-				TFTLCD_DELAY8, 120,
-				0x29, 0
-			};
-			init_table8(ILI9488_regValues, sizeof(ILI9488_regValues));
+			init_9488();
 			break;
 		case 0x9225:
-			lcd_driver = ID_9225;
-			//WIDTH = 176,HEIGHT = 220;
-			//width = WIDTH, height = HEIGHT;
-			XC=0x20,YC=0x21,CC=0x22,RC=0x22,SC1=0x31,SC2=0x33,MD=0x03,VL=1,R24BIT=0;
-			static const uint16_t ILI9225_regValues[] PROGMEM = 
-			{
-				0x01, 0x011C,
-				0x02, 0x0100,	
-				0x03, 0x1030,
-				0x08, 0x0808, // set BP and FP
-				0x0B, 0x1100, // frame cycle
-				0x0C, 0x0000, // RGB interface setting R0Ch=0x0110 for RGB 18Bit and R0Ch=0111for RGB16Bit
-				0x0F, 0x1401, // Set frame rate----0801
-				0x15, 0x0000, // set system interface
-				0x20, 0x0000, // Set GRAM Address
-				0x21, 0x0000, // Set GRAM Address
-				//*************Power On sequence ****************//
-				TFTLCD_DELAY16, 50, // delay 50ms
-				0x10, 0x0800, // Set SAP,DSTB,STB----0A00
-				0x11, 0x1F3F, // Set APON,PON,AON,VCI1EN,VC----1038
-				TFTLCD_DELAY16, 50, // delay 50ms
-				0x12, 0x0121, // Internal reference voltage= Vci;----1121
-				0x13, 0x006F, // Set GVDD----0066
-				0x14, 0x4349, // Set VCOMH/VCOML voltage----5F60
-				//-------------- Set GRAM area -----------------//
-				0x30, 0x0000,
-				0x31, 0x00DB,
-				0x32, 0x0000,
-				0x33, 0x0000,
-				0x34, 0x00DB,
-				0x35, 0x0000,
-				0x36, 0x00AF,
-				0x37, 0x0000,
-				0x38, 0x00DB,
-				0x39, 0x0000,
-				// ----------- Adjust the Gamma Curve ----------//
-				0x50, 0x0001, // 0x0400
-				0x51, 0x200B, // 0x060B
-				0x52, 0x0000, // 0x0C0A
-				0x53, 0x0404, // 0x0105
-				0x54, 0x0C0C, // 0x0A0C
-				0x55, 0x000C, // 0x0B06
-				0x56, 0x0101, // 0x0004
-				0x57, 0x0400, // 0x0501
-				0x58, 0x1108, // 0x0E00
-				0x59, 0x050C, // 0x000E
-				TFTLCD_DELAY16, 50, // delay 50ms
-				0x07, 0x1017,
-				//0x22, 0x0000,
-			};
-			init_table16(ILI9225_regValues, sizeof(ILI9225_regValues));
+			init_9225();
 			break;
 		case 0x7735:
-			if(HEIGHT == 160)
-			{
-				lcd_driver = ID_7735;
-			}
-			else if(HEIGHT == 128)
-			{
-				lcd_driver = ID_7735_128;
-			}
-			//WIDTH = 128,HEIGHT = 160;
-			//width = WIDTH, height = HEIGHT;
-			XC=ILI9341_COLADDRSET,YC=ILI9341_PAGEADDRSET,CC=ILI9341_MEMORYWRITE,RC=HX8357_RAMRD,SC1=0x33,SC2=0x37,MD=ILI9341_MADCTL,VL=0,R24BIT=0;
-			static const uint8_t ST7735S_regValues[] PROGMEM = {
-				0x11, 0,
-				TFTLCD_DELAY8, 120,
-				0xB1, 3, 0x05, 0x3C, 0x3C,
-				0xB2, 3, 0x05, 0x3C, 0x3C,
-				0xB3, 6, 0x05, 0x3C, 0x3C, 0x05, 0x3C, 0x3C,
-				0xB4, 1, 0x03,
-				0xC0, 3, 0x28, 0x08, 0x04,
-				0xC1, 1, 0xC0,
-				0xC2, 2, 0x0D, 0x00,
-				0xC3, 2, 0x8D, 0x2A,
-				0xC4, 2, 0x8D, 0xEE,
-				0xC5, 1, 0x1A,
-				0x17 , 1 , 0x05,
-				0x36, 1, 0x08,
-				0xE0, 16,0x03, 0x22, 0x07, 0x0A, 0x2E, 0x30, 0x25, 0x2A, 0x28, 0x26, 0x2E, 0x3A, 0x00, 0x01, 0x03, 0x13,
-				0xE1, 16,0x04, 0x16, 0x06, 0x0D, 0x2D, 0x26, 0x23, 0x27, 0x27, 0x25, 0x2D, 0x3B, 0x00, 0x01, 0x04, 0x13,         
-				//TFTLCD_DELAY8, 150,
-				0x3A, 1, 0x05,
-				0x29, 0
-			};
-			init_table8(ST7735S_regValues, sizeof(ST7735S_regValues));
+			init_7735();
 			break;
-		 case 0x1283:
-		 	lcd_driver = ID_1283A;
-
-			XC=0x45,
-			YC=0x44,
-			CC=0x22,
-			RC=HX8357_RAMRD,
-			SC1=0x41,
-			SC2=0x42,
-			MD=0x03,
-			VL=1,
-			R24BIT=0;
-
-		 	static const uint16_t SSD1283A_regValues[] PROGMEM =  {
-				0x10, 0x2F8E,
-				0x11, 0x000C,
-				0x07, 0x0021,
-				0x28, 0x0006,
-				0x28, 0x0005,
-				0x27, 0x057F,
-				0x29, 0x89A1,
-				0x00, 0x0001,
-				TFTLCD_DELAY16, 100,
-				0x29, 0x80B0,
-				TFTLCD_DELAY16, 30, 
-				0x29, 0xFFFE,
-				0x07, 0x0223,
-				TFTLCD_DELAY16, 30, 
-				0x07, 0x0233,
-				0x01, 0x2183,
-				0x03, 0x6830,
-				0x2F, 0xFFFF,
-				0x2C, 0x8000,
-				0x27, 0x0570,
-				0x02, 0x0300,
-				0x0B, 0x580C,
-				0x12, 0x0609,
-				0x13, 0x3100, 
-			};
-			init_table16(SSD1283A_regValues, sizeof(SSD1283A_regValues));
+		case 0x1283:
+			init_1283a();
 			break;
 		case 0x7796:
-			lcd_driver = ID_7796;
-			XC=ILI9341_COLADDRSET, // 0x2A
-			YC=ILI9341_PAGEADDRSET, // 0x2B
-			CC=ILI9341_MEMORYWRITE, // 0x2C
-			RC=HX8357_RAMRD, // 0x2E
-			SC1=0x33, // Vertical scrolling definition
-			SC2=0x37, // Vertical scrolling start address of RAM
-			MD=ILI9341_MADCTL, // 0x36 - Memory Data Access Contro
-			VL=0, // This is to do with the display inversion control
-			R24BIT=1; // this is about reading the colour from the display in 24 bit or 16 bit
-
-			static const uint8_t ST7796S_regValues[] PROGMEM = {
-				0xF0, 1, 0xC3,
-				0xF0, 1, 0x96, 
-				0x36, 1, 0x68,
-				0x3A, 1, 0x05,
-				0xB0, 1, 0x80, 
-				0xB6, 2, 0x00, 0x02,
-				0xB5, 4, 0x02, 0x03, 0x00, 0x04,
-				0xB1, 2, 0x80, 0x10, 
-				0xB4, 1, 0x00,
-				0xB7, 1, 0xC6,
-				0xC5, 1, 0x24,
-				0xE4, 1, 0x31,
-				0xE8, 8, 0x40, 0x8A, 0x00, 0x00, 0x29, 0x19, 0xA5, 0x33,
-				0xC2, 0,
-				0xA7, 0,
-				0xE0, 14, 0xF0, 0x09, 0x13, 0x12, 0x12, 0x2B, 0x3C, 0x44, 0x4B, 0x1B, 0x18, 0x17, 0x1D, 0x21,
-				0xE1, 14, 0xF0, 0x09, 0x13, 0x0C, 0x0D, 0x27, 0x3B, 0x44, 0x4D, 0x0B, 0x17 ,0x17, 0x1D, 0x21,				
-				0x36, 1, 0x48,
-				0xF0, 1, 0xC3,
-				0xF0, 1, 0x69, 
-				0x13, 0,
-				0x11, 0,
-				0x29, 0,
-			};
-			init_table8(ST7796S_regValues, sizeof(ST7796S_regValues));
+			init_7796();
 			break;
 		case 0x1106:
-		 	lcd_driver = ID_1106;
-
-			XC=0x10,
-			YC=0xB0,
-			CC=0,
-			RC=0,
-			SC1=0,
-			SC2=0,
-			MD=0,
-			VL=1,
-			R24BIT=0;
-
-			static const uint8_t SH1106_regValues[] PROGMEM =  {
-				0x8D, 0,
-				0x10, 0,
-				0xAE, 0,
-				0x02, 0,
-				0x10, 0,
-				0x40, 0,
-				0x81, 0,
-				0xCF, 0,
-				0xA1, 0,
-				0xC8, 0,
-				0xA6, 0,
-				0xA8, 0,
-				0x3F, 0,
-				0xD3, 0,
-				0x00, 0,
-				0xD5, 0,
-				0x80, 0,
-				0xD9, 0,
-				0xF1, 0,
-				0xDA, 0,
-				0x12, 0,
-				0xDB, 0,
-				0x40, 0,
-				0x20, 0,
-				0x02, 0,
-				0x8D, 0,
-				0x14, 0,
-				0xA4, 0,
-				0xA6, 0,
-				0xAF, 0,
-			};
-			init_table8(SH1106_regValues, sizeof(SH1106_regValues));
+			init_1106();
 			break;
 		default:
 			lcd_driver = ID_UNKNOWN;
@@ -2154,3 +3926,17 @@ void LCDWIKI_SPI::start(uint16_t ID) {
 	Set_Rotation(rotation); 
 	Invert_Display(false);
 }
+
+// the pixel formats that LCDWIKI_SPI_T can ask for
+template void LCDWIKI_SPI::Push_Compressed_Image_T<2>(int16_t x, int16_t y, uint16_t *block, uint8_t flags);
+template void LCDWIKI_SPI::Push_Compressed_Image_T<3>(int16_t x, int16_t y, uint16_t *block, uint8_t flags);
+template void LCDWIKI_SPI::Push_Indexed_Image_T<2>(int16_t x, int16_t y, uint8_t *block, uint8_t flags);
+template void LCDWIKI_SPI::Push_Indexed_Image_T<3>(int16_t x, int16_t y, uint8_t *block, uint8_t flags);
+template void LCDWIKI_SPI::Push_Any_Color_T<2>(uint16_t * block, int16_t n, bool first, uint8_t flags);
+template void LCDWIKI_SPI::Push_Any_Color_T<3>(uint16_t * block, int16_t n, bool first, uint8_t flags);
+template void LCDWIKI_SPI::Push_Any_Color_T<2>(uint8_t * block, int16_t n, bool first, uint8_t flags);
+template void LCDWIKI_SPI::Push_Any_Color_T<3>(uint8_t * block, int16_t n, bool first, uint8_t flags);
+template void LCDWIKI_SPI::Push_Same_Color_T<2>(uint16_t color, uint16_t n, bool first);
+template void LCDWIKI_SPI::Push_Same_Color_T<3>(uint16_t color, uint16_t n, bool first);
+template void LCDWIKI_SPI::Fill_Rect_T<2>(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+template void LCDWIKI_SPI::Fill_Rect_T<3>(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
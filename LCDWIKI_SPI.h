@@ -20,6 +20,7 @@
 #endif
 
 #include "LCDWIKI_GUI.h"
+#include "LCDWIKI_Damage.h"
 
 
 #define ROTATION_0    0
@@ -43,6 +44,65 @@
 #define ID_7796     12
 #define ID_UNKNOWN  0xFF
 
+// Size of the SRAM staging buffer used by the block write path, a multiple
+// of 6 so that both the 16 and 18 bit pixel formats (and a pair of either)
+// fill it exactly.  Its length and the counts that walk it are 8 bits, so it
+// can be no bigger than 252.
+#ifndef SPI_BLOCK_SIZE
+	#define SPI_BLOCK_SIZE 48
+#endif
+static_assert((SPI_BLOCK_SIZE > 0) && (SPI_BLOCK_SIZE <= 255) && (SPI_BLOCK_SIZE % 6 == 0), 
+		"SPI_BLOCK_SIZE must be a multiple of 6 up to 252");
+
+// The hardware SPI clock rates, for writing and for reading back (which most
+// controllers need to be slower).  Set_Spi_Clock() or Init_LCD(true) change 
+// them at run time.
+#ifndef SPI_WRITE_CLOCK
+	#define SPI_WRITE_CLOCK 4000000
+#endif
+#ifndef SPI_READ_CLOCK
+	#define SPI_READ_CLOCK 4000000
+#endif
+
+// Set to 1 to keep the SH1106 RAM buffer in a static array, which costs 1 KB
+// of SRAM in every build.  Otherwise it is only allocated when an SH1106 is
+// initialised, unless the sketch supplies one with Set_SH1106_Buffer().
+#ifndef SH1106_STATIC_BUFFER
+	#define SH1106_STATIC_BUFFER 0
+#endif
+
+// Set_Palette_Entry() sends the pixels of one colour a row span at a time,
+// and gaps of up to this many other pixels between two spans are sent along
+// with them, which is cheaper than a new column address (6 bytes)
+#ifndef PALETTE_SPAN_GAP
+	#define PALETTE_SPAN_GAP 3
+#endif
+
+#include "lcd_spi_transport.h"
+
+// Size of each of the buffers that the async push functions encode pixels
+// into, it should be a multiple of 6 bytes.  Where the transport has DMA there
+// are two of them, so that one can be filled while the other is on the wire.
+#ifndef SPI_ASYNC_CHUNK
+	#if defined(__SAM3X8E__)
+		#define SPI_ASYNC_CHUNK 960
+	#else
+		#define SPI_ASYNC_CHUNK SPI_BLOCK_SIZE
+	#endif
+#endif
+
+#if defined(LCDWIKI_TRANSPORT_ASYNC)
+	#define SPI_ASYNC_BUFFERS 2
+#else
+	#define SPI_ASYNC_BUFFERS 1
+#endif
+
+// called when an async push has finished, with the argument given to Set_Async_Callback()
+typedef void (*lcd_async_callback)(void *arg);
+
+// draws the display onto gui, see Render_Bands()
+typedef void (*lcd_draw_callback)(LCDWIKI_GUI &gui, void *arg);
+
 // LCD controller chip model identifiers
 #define ILI9325     0
 #define ILI9328     1
@@ -61,6 +121,12 @@
 #define ST7796S     14
 
 
+class LCDWIKI_Canvas;
+class LCDWIKI_Mono_Canvas;
+class LCDWIKI_Indexed_Canvas;
+class LCDWIKI_Damage;
+class LCDWIKI_Font;
+
 typedef struct _lcd_info {
 	uint16_t lcd_id;
 	int16_t lcd_wid;
@@ -74,12 +140,18 @@ class LCDWIKI_SPI:public LCDWIKI_GUI {
 		LCDWIKI_SPI(int16_t wid, int16_t heg, int8_t cs, int8_t cd, int8_t miso, int8_t mosi, int8_t reset, int8_t clk,int8_t led);
 		LCDWIKI_SPI(int16_t wid, int16_t heg, int8_t cs, int8_t cd, int8_t reset,int8_t led);
 
-		void Init_LCD(void);
+		void Init_LCD(boolean calibrate = false);
 		void reset(void);
 		void start(uint16_t ID);
 		void Draw_Pixe(int16_t x, int16_t y, uint16_t color);
 		void Spi_Write(uint8_t data);
+		void Spi_Write_Block(const uint8_t *block, size_t n);
+		LCDWIKI_Transport &Get_Transport(void);
 		uint8_t Spi_Read(void);
+		void Set_Spi_Clock(uint32_t write_hz, uint32_t read_hz);
+		uint32_t Get_Spi_Write_Clock(void) const;
+		uint32_t Get_Spi_Read_Clock(void) const;
+		boolean Calibrate_Spi_Clock(void);
 		void Write_Cmd(uint16_t cmd);
 		void Write_Data(uint16_t data);
 		void Write_Cmd_Data(uint16_t cmd, uint16_t data);
@@ -89,14 +161,19 @@ class LCDWIKI_SPI:public LCDWIKI_GUI {
 		uint16_t Color_To_565(uint8_t r, uint8_t g, uint8_t b);
 		uint16_t Read_ID(void);
 		void Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+		void Draw_Line(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
 		void Set_Rotation(uint8_t r); 
 		uint8_t Get_Rotation(void) const;
 		void Invert_Display(boolean i);
 		void SH1106_Display(void);
 		void SH1106_Draw_Bitmap(uint8_t x,uint8_t y,uint8_t width, uint8_t height, uint8_t *BMP, uint8_t mode);
+		void SH1106_Invert_Rect(int16_t x, int16_t y, int16_t w, int16_t h);
+		void Set_SH1106_Buffer(uint8_t *buffer);
+		uint8_t *Get_SH1106_Buffer(void) const;
 		uint16_t Read_Reg(uint16_t reg, int8_t index);
 		int16_t Read_GRAM(int16_t x, int16_t y, uint16_t *block, int16_t w, int16_t h);
 		void Set_Addr_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+		void Invalidate_Addr_Window(void);
 
 		void Push_Any_Color(uint16_t *block, int16_t n, bool first, uint8_t flags);
 		void Push_Any_Color(uint8_t * block, int16_t n, bool first, uint8_t flags);
@@ -105,14 +182,72 @@ class LCDWIKI_SPI:public LCDWIKI_GUI {
 
 		void Push_Compressed_Image(int16_t x, int16_t y, uint16_t *block, uint8_t flags);
 		void Push_Indexed_Image(int16_t x, int16_t y, uint8_t *block, uint8_t flags);
+		void Push_Indexed_Image(int16_t x, int16_t y, uint8_t *block, uint8_t flags, lcd_rect *bounds, uint8_t *rows = NULL);
+		void Blit_Canvas(int16_t x, int16_t y, const LCDWIKI_Canvas &canvas);
+		void Blit_Canvas_Rect(int16_t x, int16_t y, const LCDWIKI_Canvas &canvas, int16_t sx, int16_t sy, int16_t w, int16_t h);
+		void Blit_Mono_Canvas(int16_t x, int16_t y, const LCDWIKI_Mono_Canvas &canvas, uint16_t fg, uint16_t bg);
+		void Blit_Indexed_Canvas(int16_t x, int16_t y, const LCDWIKI_Indexed_Canvas &canvas);
+		void Blit_Indexed_Canvas_Rect(int16_t x, int16_t y, const LCDWIKI_Indexed_Canvas &canvas, int16_t sx, int16_t sy, int16_t w, int16_t h);
+		void Set_Palette_Entry(int16_t x, int16_t y, LCDWIKI_Indexed_Canvas &canvas, uint8_t index, uint16_t color);
+		void Set_Palette_Entry(int16_t x, int16_t y, uint8_t *block, uint8_t flags, uint8_t index, uint16_t color, 
+				const lcd_rect *bounds = NULL, const uint8_t *rows = NULL);
+		void Draw_Glyph(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg, uint8_t flags);
+		void Draw_Alpha_Glyph(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint8_t bits, uint16_t fg, uint16_t bg, uint8_t flags);
+		int16_t Draw_Font_String(int16_t x, int16_t y, const LCDWIKI_Font &font, const char *str, uint16_t fg, uint16_t bg, uint8_t flags);
+		void Render_Bands(LCDWIKI_Canvas &band, lcd_draw_callback draw, void *arg);
+
+		void Begin_Frame(LCDWIKI_Canvas &shadow, LCDWIKI_Damage &damage, int16_t x = 0, int16_t y = 0);
+		void End_Frame(void);
+
+		void Push_Any_Color_Async(const uint16_t *block, uint32_t n, bool first, uint8_t flags);
+		void Fill_Rect_Async(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+		void Set_Async_Callback(lcd_async_callback callback, void *arg);
+		boolean Is_Busy(void);
+		inline void Wait_Async(void) { while(async_active) { Async_Pump(); } }
+
+		void Begin_Batch(void);
+		void End_Batch(void);
 
 		void Vert_Scroll(int16_t top, int16_t scrollines, int16_t offset);
+		boolean Can_Vert_Scroll(void) const;
+		int16_t Get_Scroll_Offset(void) const;
 		int16_t Get_Height(void) const;
 		int16_t Get_Width(void) const;
 		void Set_LR(void);
 		void Led_control(boolean i);
 
 	protected:
+		void init_932x(void);
+		void init_9341(void);
+		void init_hx8357d(void);
+		void init_7575(void);
+		void init_9486(void);
+		void init_9488(void);
+		void init_9225(void);
+		void init_7735(void);
+		void init_1283a(void);
+		void init_7796(void);
+		void init_1106(void);
+
+		void Set_Addr_Window_DCS(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+		boolean Frame_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+		boolean Frame_Covers(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+
+		// the pixel pushing functions for one pixel format, PIXEL_BYTES is 
+		// 2 for rgb565 or 3 for rgb666 (ILI9488_18), or 0 for the frame's
+		// shadow canvas (see Begin_Frame())
+		template<uint8_t PIXEL_BYTES> void Push_Any_Color_T(uint16_t *block, int16_t n, bool first, uint8_t flags);
+		template<uint8_t PIXEL_BYTES> void Push_Any_Color_T(uint8_t *block, int16_t n, bool first, uint8_t flags);
+		template<uint8_t PIXEL_BYTES> void Push_Same_Color_T(uint16_t color, uint16_t n, bool first);
+		template<uint8_t PIXEL_BYTES> void Push_Compressed_Image_T(int16_t x, int16_t y, uint16_t *block, uint8_t flags);
+		template<uint8_t PIXEL_BYTES> void Push_Indexed_Image_T(int16_t x, int16_t y, uint8_t *block, uint8_t flags);
+		void Map_Indexed_Image(const uint8_t *block, uint8_t flags, lcd_rect *bounds, uint8_t *rows);
+		template<uint8_t PIXEL_BYTES> void Fill_Rect_T(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+		template<uint8_t PIXEL_BYTES> void Blit_Indexed_Canvas_T(int16_t x, int16_t y, const LCDWIKI_Indexed_Canvas &canvas, int16_t sx, int16_t sy, int16_t w, int16_t h);
+		template<uint8_t PIXEL_BYTES> void Draw_Glyph_T(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint16_t fg, uint16_t bg, uint8_t flags);
+		template<uint8_t PIXEL_BYTES> void Draw_Alpha_Glyph_T(int16_t x, int16_t y, const uint8_t *bitmap, int16_t w, int16_t h, uint8_t bits, uint8_t flags);
+		void Set_Alpha_Colors(uint8_t bits, uint16_t fg, uint16_t bg);
+
 		uint8_t xoffset;
 		uint8_t yoffset;
 
@@ -125,6 +260,65 @@ class LCDWIKI_SPI:public LCDWIKI_GUI {
 		uint16_t lcd_model;
 
 		boolean hw_spi;
+		LCDWIKI_Transport bus;
+
+		// the levels the bus lines were last driven to, so that the macros in
+		// mcu_spi_magic.h only drive a pin when its level changes, and the 
+		// number of open Begin_Batch() calls that are holding the chip select
+		boolean cs_active;
+		boolean cd_data;
+		uint8_t batch_depth;
+
+		// the DCS address window that was last sent (with the offsets added)
+		boolean win_valid;
+		int16_t win_x1;
+		int16_t win_x2;
+		int16_t win_y1;
+		int16_t win_y2;
+
+		// the frame that drawing goes to between Begin_Frame() and End_Frame(),
+		// and whether the last address window was all on its shadow canvas
+		LCDWIKI_Canvas *frame_shadow;
+		LCDWIKI_Damage *frame_damage;
+		int16_t frame_x;
+		int16_t frame_y;
+		boolean frame_inside;
+
+		// the colours of the last anti-aliased glyph, each level of alpha
+		// blended from bg to fg, kept until the colours change
+		uint8_t alpha_bits;
+		uint16_t alpha_fg;
+		uint16_t alpha_bg;
+		uint16_t alpha_lut[16];
+
+		inline void Bus_Cs_Active(void) {
+			Wait_Async();
+			if(!cs_active) {
+				bus.Cs_Active();
+				cs_active = true;
+			}
+		}
+
+		inline void Bus_Cs_Idle(void) {
+			if(cs_active && !batch_depth) {
+				bus.Cs_Idle();
+				cs_active = false;
+			}
+		}
+
+		inline void Bus_Cd_Command(void) {
+			if(cd_data) {
+				bus.Cd_Command();
+				cd_data = false;
+			}
+		}
+
+		inline void Bus_Cd_Data(void) {
+			if(!cd_data) {
+				bus.Cd_Data();
+				cd_data = true;
+			}
+		}
 
 	private:
 		uint16_t XC;
@@ -138,23 +332,6 @@ class LCDWIKI_SPI:public LCDWIKI_GUI {
 		uint16_t R24BIT;
 		uint16_t MODEL;
  
-		volatile uint8_t *spicsPort;
-		volatile uint8_t *spicdPort;
-		volatile uint8_t *spimisoPort;
-		volatile uint8_t *spimosiPort;
-		volatile uint8_t *spiclkPort;
-
-		uint8_t spicsPinSet;
-		uint8_t spicdPinSet;
-		uint8_t spimisoPinSet;
-		uint8_t spimosiPinSet;
-		uint8_t spiclkPinSet;
-		uint8_t spicsPinUnset;
-		uint8_t spicdPinUnset;
-		uint8_t spimisoPinUnset;
-		uint8_t spimosiPinUnset;
-		uint8_t spiclkPinUnset;
-
 		int8_t _cs;
 		int8_t _cd;
 		int8_t _miso;
@@ -162,5 +339,162 @@ class LCDWIKI_SPI:public LCDWIKI_GUI {
 		int8_t _clk;
 		int8_t _reset;
 		int8_t _led;
+
+		uint8_t spi_block[SPI_BLOCK_SIZE];
+		uint8_t spi_block_len;
+
+		template<uint8_t PIXEL_BYTES> void Begin_Pixels(bool first);
+		template<uint8_t PIXEL_BYTES> void End_Pixels(void);
+		template<uint8_t PIXEL_BYTES> void Stage_Color(uint16_t color);
+		void Flush_Block(void);
+		template<uint8_t PIXEL_BYTES> void Push_Color_Repeat(uint16_t color, uint32_t n);
+
+		boolean Clip_Rect(int16_t &x, int16_t &y, int16_t &w, int16_t &h);
+		boolean Crop_Blit(int16_t &x, int16_t &y, int16_t &sx, int16_t &sy, int16_t &w, int16_t &h);
+		void Async_Pump(void);
+		template<uint8_t PIXEL_BYTES> void Async_Prepare(void);
+
+		// the async push that is running, see Async_Pump()
+		boolean async_active;
+		boolean async_fill;
+		uint8_t async_flags;
+		uint8_t async_which;
+		uint16_t async_len;
+		uint16_t async_color;
+		uint32_t async_left;
+		const uint16_t *async_src;
+		lcd_async_callback async_callback;
+		void *async_arg;
+		uint8_t async_buf[SPI_ASYNC_BUFFERS][SPI_ASYNC_CHUNK];
+};
+
+/*!
+ * @brief LCDWIKI_SPI with the controller model fixed at compile time, for 
+ *   example:
+ *
+ *     LCDWIKI_SPI_T<ST7796S> mylcd(CS, CD, RST, LED); // hardware spi
+ *
+ *   Only the pixel format and the address window are specialised: the pixel
+ *   pushing functions go straight to the format of the model, and a DCS 
+ *   controller gets the DCS address window and Draw_Pixe() without the 
+ *   checks for the other controllers.  start() calls only the one init_*() 
+ *   function, so when the linker drops unused sections (as the Arduino 
+ *   builds do) the other models' register tables are left out.
+ *
+ *   The rest is still the run time LCDWIKI_SPI: Fill_Rect_T(), 
+ *   Begin_Pixels() and the non DCS address window test lcd_driver and the
+ *   XC/YC/CC registers as before, and the LCDWIKI_SPI vtable (which the 
+ *   base constructor needs) keeps the kernels for both pixel formats linked.
+ *
+ * @warning The model is fixed, so start() takes no ID and Init_LCD() never
+ *   calls Read_ID()
+ */
+template<uint16_t M>
+class LCDWIKI_SPI_T:public LCDWIKI_SPI {
+	public:
+		// bytes per pixel on the wire, only the ILI9488_18 is in 18 bit colour
+		static const uint8_t PIXEL_BYTES = (M == ILI9488_18) ? 3 : 2;
+
+		// whether the controller uses the MIPI DCS column and page address commands
+		static const bool IS_DCS = (M == ILI9341) || (M == HX8357D) || (M == ILI9486) || 
+				(M == ST7735S) || (M == ST7735S128) || (M == ILI9488) || (M == ILI9488_18) || 
+				(M == ST7796S);
+
+		LCDWIKI_SPI_T(int8_t cs, int8_t cd, int8_t miso, int8_t mosi, int8_t reset, int8_t clk, int8_t led):
+				LCDWIKI_SPI(M, cs, cd, miso, mosi, reset, clk, led) {}
+		LCDWIKI_SPI_T(int8_t cs, int8_t cd, int8_t reset, int8_t led):
+				LCDWIKI_SPI(M, cs, cd, reset, led) {}
+
+		void Init_LCD(boolean calibrate = false) {
+			reset();
+			Led_control(true);
+			start();
+
+			if(calibrate) {
+				Calibrate_Spi_Clock();
+			}
+		}
+
+		void start(void) {
+			reset();
+			delay(200);
+
+			// M is a constant, so everything but the one call is thrown away
+			if((M == ILI9325) || (M == ILI9328)) {
+				init_932x();
+			} else if(M == ILI9341) {
+				init_9341();
+			} else if(M == HX8357D) {
+				init_hx8357d();
+			} else if((M == HX8347G) || (M == HX8347I)) {
+				init_7575();
+			} else if(M == ILI9486) {
+				init_9486();
+			} else if((M == ILI9488) || (M == ILI9488_18)) {
+				init_9488();
+			} else if(M == ILI9225) {
+				init_9225();
+			} else if((M == ST7735S) || (M == ST7735S128)) {
+				init_7735();
+			} else if(M == SSD1283A) {
+				init_1283a();
+			} else if(M == ST7796S) {
+				init_7796();
+			} else if(M == SH1106) {
+				init_1106();
+			}
+
+			Set_Rotation(rotation);
+			Invert_Display(false);
+		}
+
+		void Set_Addr_Window(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+			if(IS_DCS && !frame_shadow) {
+				Set_Addr_Window_DCS(x1, y1, x2, y2);
+			} else {
+				LCDWIKI_SPI::Set_Addr_Window(x1, y1, x2, y2);
+			}
+		}
+
+		void Draw_Pixe(int16_t x, int16_t y, uint16_t color) {
+			if(!IS_DCS || frame_shadow) {
+				LCDWIKI_SPI::Draw_Pixe(x, y, color);
+				return;
+			}
+
+			if((x < 0) || (y < 0) || (x >= Get_Width()) || (y >= Get_Height())) {
+				return;
+			}
+
+			Set_Addr_Window_DCS(x, y, x, y);
+			Push_Same_Color_T<PIXEL_BYTES>(color, 1, true);
+		}
+
+		void Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+			Fill_Rect_T<PIXEL_BYTES>(x, y, w, h, color);
+		}
+
+		void Push_Any_Color(uint16_t *block, int16_t n, bool first, uint8_t flags) {
+			Push_Any_Color_T<PIXEL_BYTES>(block, n, first, flags);
+		}
+
+		void Push_Any_Color(uint8_t *block, int16_t n, bool first, uint8_t flags) {
+			Push_Any_Color_T<PIXEL_BYTES>(block, n, first, flags);
+		}
+
+		void Push_Same_Color(uint16_t color, uint16_t n, bool first) {
+			Push_Same_Color_T<PIXEL_BYTES>(color, n, first);
+		}
+
+		void Push_Compressed_Image(int16_t x, int16_t y, uint16_t *block, uint8_t flags) {
+			Push_Compressed_Image_T<PIXEL_BYTES>(x, y, block, flags);
+		}
+
+		// the overload that builds an index map as well
+		using LCDWIKI_SPI::Push_Indexed_Image;
+
+		void Push_Indexed_Image(int16_t x, int16_t y, uint8_t *block, uint8_t flags) {
+			Push_Indexed_Image_T<PIXEL_BYTES>(x, y, block, flags);
+		}
 };
 #endif
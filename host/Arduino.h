@@ -0,0 +1,46 @@
+// Minimal stand in for the Arduino core, so that LCDWIKI_SPI can be compiled
+// and run on a host (Linux, macOS, ...) with the recording transport.
+// MIT license
+//
+// Put this directory on the include path, for example:
+//
+//   g++ -std=gnu++11 -Ihost -I. -I<path to LCDWIKI_GUI> my_test.cpp *.cpp <path to LCDWIKI_GUI>/LCDWIKI_GUI.cpp
+//
+// host/host_test.cpp checks the bytes that the drivers send this way, see 
+// the top of it for how to build and run it.
+//
+// Only the parts of the core that the drivers use are here, pins and delays
+// do nothing at all.
+
+#ifndef _lcdwiki_host_arduino_
+#define _lcdwiki_host_arduino_
+
+#define LCDWIKI_HOST
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint8_t u8;
+
+#define HIGH   0x1
+#define LOW    0x0
+#define INPUT  0x0
+#define OUTPUT 0x1
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+#define pgm_read_word(addr) (*(const unsigned short *)(addr))
+#define pgm_read_dword(addr) (*(const unsigned long *)(addr))
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline void delay(unsigned long) {}
+inline void delayMicroseconds(unsigned int) {}
+
+#endif // _lcdwiki_host_arduino_
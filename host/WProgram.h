@@ -0,0 +1,2 @@
+// Pre 1.0 name of the Arduino core header
+#include "Arduino.h"
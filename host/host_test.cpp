@@ -0,0 +1,247 @@
+// Bus traffic checks for LCDWIKI_SPI, run on a host with the recording
+// transport (see lcd_spi_transport.h)
+// MIT license
+//
+// The drivers derive from LCDWIKI_GUI, which is the separate LCDWIKI_GUI 
+// library (LCDWIKI_GUI.h and LCDWIKI_GUI.cpp).  In an Arduino sketchbook it
+// is installed next to this one, in libraries/LCDWIKI_GUI; point GUI at 
+// wherever it is.  Build and run from this library's directory:
+//
+//   GUI=../LCDWIKI_GUI
+//   g++ -std=gnu++11 -Ihost -I. -I$GUI host/host_test.cpp *.cpp $GUI/LCDWIKI_GUI.cpp -o host_test
+//   ./host_test
+//
+// host/ stands in for the Arduino core, and the driver picks the recording
+// transport when LCDWIKI_HOST is defined (see lcd_spi_transport.h).
+//
+// Most checks draw on an ST7796S and compare the bytes and CS/CD edges 
+// that went on the wire with what the driver is meant to send, the rest
+// run the SH1106 buffer, the damage list and the fonts on their own.  Each
+// failure is printed, and the exit status is the number of checks that 
+// failed.
+
+#include "LCDWIKI_SPI.h"
+#include "LCDWIKI_Canvas.h"
+#include "LCDWIKI_Damage.h"
+#include "LCDWIKI_Font.h"
+#include <stdio.h>
+
+static int failed = 0;
+
+#define CHECK_EQUAL(what, got, expect) Check(what, #got, (uint32_t)(got), (uint32_t)(expect))
+
+static void Check(const char *what, const char *name, uint32_t got, uint32_t expect) {
+	if(got != expect) {
+		printf("FAIL %s: %s is %lu, expected %lu\n", what, name, (unsigned long)got, (unsigned long)expect);
+		failed++;
+	}
+}
+
+// 100 pixels down one column, the column address is only sent for the
+// first one, and the page address is 4 bytes for each
+static void Test_Window_Cache(LCDWIKI_SPI &lcd, LCDWIKI_Transport &t) {
+	lcd.Invalidate_Addr_Window();
+	t.Reset();
+	for(int16_t i = 0; i < 100; i++) {
+		lcd.Draw_Pixe(10, i, 0xFFFF);
+	}
+
+	CHECK_EQUAL("window cache", t.Get_Cmd_Bytes(), 402);
+	CHECK_EQUAL("window cache", t.Get_Data_Bytes(), 604);
+}
+
+// the same pixels in a batch keep the chip selected throughout, rather than
+// selecting it for the window and again for the colour of every pixel (an
+// edge is counted each way)
+static void Test_Batch(LCDWIKI_SPI &lcd, LCDWIKI_Transport &t) {
+	lcd.Invalidate_Addr_Window();
+	t.Reset();
+	for(int16_t i = 0; i < 100; i++) {
+		lcd.Draw_Pixe(10, i, 0xFFFF);
+	}
+	CHECK_EQUAL("unbatched", t.Get_Cs_Edges(), 400);
+	CHECK_EQUAL("unbatched", t.Get_Pin_Writes(), 802);
+
+	lcd.Invalidate_Addr_Window();
+	t.Reset();
+	lcd.Begin_Batch();
+	for(int16_t i = 0; i < 100; i++) {
+		lcd.Draw_Pixe(10, i, 0xFFFF);
+	}
+	lcd.End_Batch();
+	CHECK_EQUAL("batched", t.Get_Cs_Edges(), 2);
+	CHECK_EQUAL("batched", t.Get_Pin_Writes(), 404);
+}
+
+// a shallow line across the display goes out a run at a time, 11 windows
+// of one row each rather than a window for each pixel: the column and page
+// commands (2 bytes each) and the memory write command for each run, 8 
+// bytes of window and 2 bytes for each of the 291 pixels
+static void Test_Line_Runs(LCDWIKI_SPI &lcd, LCDWIKI_Transport &t) {
+	lcd.Set_Draw_color(0xFFFF);
+	lcd.Invalidate_Addr_Window();
+	t.Reset();
+	lcd.Draw_Line(10, 10, 300, 20);
+
+	CHECK_EQUAL("line runs", t.Get_Cmd_Bytes(), 11 * 5);
+	CHECK_EQUAL("line runs", t.Get_Data_Bytes(), 11 * 8 + 291 * 2);
+	CHECK_EQUAL("line runs", t.Get_Cs_Edges(), 2);
+
+	// a horizontal line is LCDWIKI_GUI's, through Fill_Rect(), and is one 
+	// window and one burst of colour
+	lcd.Invalidate_Addr_Window();
+	t.Reset();
+	lcd.Draw_Fast_HLine(0, 5, 100);
+	CHECK_EQUAL("fast line", t.Get_Data_Bytes(), 8 + 100 * 2);
+}
+
+// a canvas half off the bottom left corner is cropped and sent through one
+// window, with the chip selected once for the window and once for the pixels
+static void Test_Blit_Canvas(LCDWIKI_SPI &lcd, LCDWIKI_Transport &t) {
+	static uint16_t pixels[20 * 10];
+	LCDWIKI_Canvas canvas(20, 10, pixels);
+
+	canvas.Fill_Rect(0, 0, 20, 10, 0x07E0);
+	lcd.Invalidate_Addr_Window();
+	t.Reset();
+	lcd.Blit_Canvas(-10, lcd.Get_Height() - 5, canvas);
+
+	CHECK_EQUAL("blit canvas", t.Get_Cmd_Bytes(), 5);
+	CHECK_EQUAL("blit canvas", t.Get_Cs_Edges(), 4);
+	CHECK_EQUAL("blit canvas", t.Get_Data_Bytes(), 8 + 10 * 5 * 2);
+}
+
+// touching rectangles are merged, one that is apart is kept, and Sort()
+// starts from the top left
+static void Test_Damage(void) {
+	LCDWIKI_Damage damage;
+
+	damage.Add(10, 10, 19, 19);
+	damage.Add(20, 10, 29, 19);
+	damage.Add(100, 0, 109, 9);
+	damage.Add(5, 5, 4, 4);
+	CHECK_EQUAL("damage merge", damage.Get_Count(), 2);
+
+	damage.Sort();
+	CHECK_EQUAL("damage sort", damage.Get_Rect(0).x1, 100);
+	CHECK_EQUAL("damage sort", damage.Get_Rect(1).x1, 10);
+	CHECK_EQUAL("damage sort", damage.Get_Rect(1).x2, 29);
+
+	// once the list is full, each new rectangle is merged into another
+	damage.Clear();
+	for(int16_t i = 0; i < DAMAGE_MAX_RECTS + 2; i++) {
+		damage.Add(i * 10, 0, i * 10, 0);
+	}
+	CHECK_EQUAL("damage full", damage.Get_Count(), DAMAGE_MAX_RECTS);
+}
+
+// the SH1106 only sends the columns of each page that have changed: the
+// whole display the first time, nothing when it is clean, and a 10 column
+// rectangle across two pages is 3 commands and 10 bytes for each
+static void Test_SH1106_Dirty(void) {
+	LCDWIKI_SPI oled(SH1106, 10, 9, 8, -1);
+	oled.Init_LCD();
+	LCDWIKI_Transport &t = oled.Get_Transport();
+
+	t.Reset();
+	oled.SH1106_Display();
+	CHECK_EQUAL("sh1106 first", t.Get_Data_Bytes(), 128 * 8);
+
+	t.Reset();
+	oled.SH1106_Display();
+	CHECK_EQUAL("sh1106 clean", t.Get_Data_Bytes(), 0);
+
+	t.Reset();
+	oled.Fill_Rect(20, 5, 10, 8, 1);
+	CHECK_EQUAL("sh1106 buffered", t.Get_Data_Bytes(), 0);
+	oled.SH1106_Display();
+	CHECK_EQUAL("sh1106 dirty", t.Get_Cmd_Bytes(), 2 * 3);
+	CHECK_EQUAL("sh1106 dirty", t.Get_Data_Bytes(), 2 * 10);
+}
+
+// recolouring an index sends only the spans that use it, a window of 8
+// bytes and 2 bytes for each pixel of the span
+static void Test_Palette_Entry(LCDWIKI_SPI &lcd, LCDWIKI_Transport &t) {
+	static uint8_t pixels[20 * 10 / 2];
+	LCDWIKI_Indexed_Canvas canvas(20, 10, 4, pixels);
+	const uint8_t palette[] = { 0x00, 0x00, 0xF8, 0x00 };
+	lcd_rect canvasBounds[16];
+	uint8_t canvasRows[16 * 2];
+
+	canvas.Set_Palette(palette, 2, 0);
+	canvas.Set_Index_Map(canvasBounds, canvasRows);
+	canvas.Fill_Rect(0, 0, 20, 10, 0);
+	canvas.Fill_Rect(2, 3, 4, 1, 1);
+	lcd.Blit_Indexed_Canvas(0, 0, canvas);
+
+	t.Reset();
+	lcd.Set_Palette_Entry(0, 0, canvas, 1, 0x07E0);
+	CHECK_EQUAL("canvas palette", t.Get_Data_Bytes(), 8 + 4 * 2);
+
+	// an image 4 pixels wide with index 1 in the top row only, the map that
+	// Push_Indexed_Image() builds puts it there
+	uint8_t image[] = { 1, 4, 3, 2, 0x00, 0x00, 0xF8, 0x00, 0x84, 1, 0x88, 0 };
+	lcd_rect bounds[2];
+	uint8_t rows[2];
+
+	lcd.Push_Indexed_Image(50, 50, image, 0, bounds, rows);
+	CHECK_EQUAL("image map", bounds[1].y1, 0);
+	CHECK_EQUAL("image map", bounds[1].y2, 0);
+	CHECK_EQUAL("image map", bounds[0].y1, 1);
+	CHECK_EQUAL("image map", rows[0], 0x06);
+	CHECK_EQUAL("image map", rows[1], 0x01);
+
+	lcd.Invalidate_Addr_Window();
+	t.Reset();
+	lcd.Set_Palette_Entry(50, 50, image, 0, 1, 0x07E0, bounds, rows);
+	CHECK_EQUAL("image palette", t.Get_Data_Bytes(), 8 + 4 * 2);
+	CHECK_EQUAL("image palette", (image[6] << 8) | image[7], 0x07E0);
+}
+
+// Find() is a binary search of the codes, and Next_Char() decodes UTF-8
+static void Test_Font(void) {
+	static const uint16_t codes[] = { 0x0041, 0x4E2D, 0xFF01 };
+	static const uint8_t bitmaps[3 * 8] = { 0 };
+	LCDWIKI_Font font(8, 8, 3, codes, bitmaps);
+
+	CHECK_EQUAL("font find", font.Find(0x0041) - bitmaps, 0);
+	CHECK_EQUAL("font find", font.Find(0xFF01) - bitmaps, 2 * 8);
+	CHECK_EQUAL("font find", font.Find(0x0042) == NULL, true);
+
+	const char *str = "A\xE4\xB8\xAD\xF0\x9F\x98\x80\xE4";
+	CHECK_EQUAL("next char", LCDWIKI_Font::Next_Char(str), 0x0041);
+	CHECK_EQUAL("next char", LCDWIKI_Font::Next_Char(str), 0x4E2D);
+	CHECK_EQUAL("next char", LCDWIKI_Font::Next_Char(str), 0xFFFD);
+	CHECK_EQUAL("next char", LCDWIKI_Font::Next_Char(str), 0xFFFD);
+	CHECK_EQUAL("next char", LCDWIKI_Font::Next_Char(str), 0);
+}
+
+// an opaque glyph is one window and 2 bytes for every pixel, set or clear
+static void Test_Glyph(LCDWIKI_SPI &lcd, LCDWIKI_Transport &t) {
+	static const uint8_t glyph[] = { 0xA5, 0x0F };
+
+	lcd.Invalidate_Addr_Window();
+	t.Reset();
+	lcd.Draw_Glyph(30, 30, glyph, 8, 2, 0xFFFF, 0x0000, 0);
+	CHECK_EQUAL("glyph", t.Get_Cmd_Bytes(), 5);
+	CHECK_EQUAL("glyph", t.Get_Data_Bytes(), 8 + 16 * 2);
+}
+
+int main(void) {
+	LCDWIKI_SPI lcd(ST7796S, 10, 9, 8, -1);
+	lcd.Init_LCD();
+	LCDWIKI_Transport &t = lcd.Get_Transport();
+
+	Test_Window_Cache(lcd, t);
+	Test_Batch(lcd, t);
+	Test_Line_Runs(lcd, t);
+	Test_Blit_Canvas(lcd, t);
+	Test_Palette_Entry(lcd, t);
+	Test_Glyph(lcd, t);
+	Test_Damage();
+	Test_SH1106_Dirty();
+	Test_Font();
+
+	printf("%s, %d failed\n", failed ? "FAILED" : "passed", failed);
+	return failed;
+}
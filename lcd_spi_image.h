@@ -0,0 +1,60 @@
+// The header of the indexed image format that LCDWIKI_SPI::Push_Indexed_Image()
+// draws, shared with everything else in the library that reads the format
+// MIT license
+
+#ifndef _LCD_SPI_IMAGE_H_
+#define _LCD_SPI_IMAGE_H_
+
+#if ARDUINO >= 100
+	#include "Arduino.h"
+#else
+	#include "WProgram.h"
+#endif
+
+#ifdef __AVR__
+	#include <avr/pgmspace.h>
+#elif defined(ESP8266)
+	#include <pgmspace.h>
+#elif !defined(pgm_read_word)
+	#define pgm_read_byte(addr) (*(const unsigned char *)(addr))
+	#define pgm_read_word(addr) (*(const unsigned short *)(addr))
+#endif
+
+/*!
+ * @brief Read the header of an indexed image: a byte that is non-zero for 8
+ *   bit sizes, the width and height (1 byte each, or 2 bytes each high byte
+ *   first), the number of colours, and the colour map of rgb565 colours 
+ *   high byte first
+ *
+ * @param block The image, moved on to the pixel data after the colour map
+ * @param flags 00000001 - the image is in PROGMEM, else RAM
+ * @param w Set to the width of the image
+ * @param h Set to the height of the image
+ * @param entries Set to the number of colours in the colour map
+ *
+ * @return The colour map
+ */
+static inline const uint8_t *lcd_read_indexed_header(const uint8_t *&block, uint8_t flags, uint16_t &w, uint16_t &h, uint8_t &entries) {
+	bool isconst = flags & 1;
+
+	#define NEXT_BYTE() (isconst ? pgm_read_byte(block++) : *block++)
+
+	if(NEXT_BYTE()) {
+		w = NEXT_BYTE();
+		h = NEXT_BYTE();
+	} else {
+		w = NEXT_BYTE() << 8;
+		w |= NEXT_BYTE();
+		h = NEXT_BYTE() << 8;
+		h |= NEXT_BYTE();
+	}
+	entries = NEXT_BYTE();
+
+	#undef NEXT_BYTE
+
+	const uint8_t *map = block;
+	block += entries * 2;
+	return map;
+}
+
+#endif
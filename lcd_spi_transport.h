@@ -0,0 +1,1067 @@
+// Bus transports for LCDWIKI_SPI
+// MIT license
+//
+// All access to the CS, CD, MOSI, MISO and CLK lines goes through one of the
+// transport classes below, the macros in mcu_spi_magic.h expand to calls on
+// the transport that LCDWIKI_SPI owns.  Every transport has the same members:
+//
+//   Begin(cs, cd, miso, mosi, clk, hw)  set up the pins (and the SPI peripheral if hw)
+//   Cs_Active() / Cs_Idle()             drive chip select low / high
+//   Cd_Command() / Cd_Data()            drive command/data low / high
+//   Write8(data)                        write one byte
+//   Read8()                             read one byte
+//   Write_Block(block, n)               write n bytes back to back
+//   Write_Pattern(pattern, len, count)  write the same len (1 to 4) bytes count times
+//   Read_Block(block, n)                read n bytes back to back
+//   Set_Reading(reading)                switch between the write and read clocks
+//   Set_Clock(write_hz, read_hz)        set the hardware SPI clock rates
+//   Write_Block_Async(block, n)         start writing n bytes, the block must
+//                                       not change until Is_Busy() is false
+//   Is_Busy()                           whether an async write is still running
+//
+// Only the transports that define LCDWIKI_TRANSPORT_ASYNC really run the
+// async writes in the background (DMA on the SAM3X8E, and the recording
+// transport which pretends to), the others finish them before returning.
+//
+// The transport is picked at compile time, so there is no cost over the old
+// macros:
+//
+//   LCDWIKI_HOST or LCDWIKI_RECORDING  LCDWIKI_Recording_Transport
+//   __AVR__                            LCDWIKI_AVR_Transport
+//   ARDUINO_ARCH_ESP8266               LCDWIKI_ESP8266_Transport
+//   __SAM3X8E__                        LCDWIKI_SAM3X_Transport
+//   anything else                      LCDWIKI_Arduino_Transport
+
+#ifndef _lcd_spi_transport_
+#define _lcd_spi_transport_
+
+#if !defined(LCDWIKI_HOST)
+	#include <SPI.h>
+
+/*!
+ * @brief The hardware SPI clock rates, kept as ready made SPISettings.  A 
+ *   transaction is begun when the chip is selected and ended when it is 
+ *   released, at the read rate whilst reading and the write rate otherwise.
+ */
+class LCDWIKI_Spi_Clock {
+	public:
+		void Begin(void) {
+			reading = false;
+			selected = false;
+			Set(SPI_WRITE_CLOCK, SPI_READ_CLOCK);
+		}
+
+		void Set(uint32_t write_hz, uint32_t read_hz) {
+			writeHz = write_hz;
+			readHz = read_hz;
+			writeSettings = SPISettings(write_hz, MSBFIRST, SPI_MODE0);
+			readSettings = SPISettings(read_hz, MSBFIRST, SPI_MODE0);
+
+			if(selected) {
+				SPI.endTransaction();
+				SPI.beginTransaction(reading ? readSettings : writeSettings);
+			}
+		}
+
+		inline void Select(void) {
+			SPI.beginTransaction(reading ? readSettings : writeSettings);
+			selected = true;
+		}
+
+		inline void Release(void) {
+			SPI.endTransaction();
+			selected = false;
+		}
+
+		void Set_Reading(boolean r) {
+			if(r == reading) {
+				return;
+			}
+
+			reading = r;
+			if(selected) {
+				SPI.endTransaction();
+				SPI.beginTransaction(reading ? readSettings : writeSettings);
+			}
+		}
+
+		uint32_t Get_Write_Clock(void) const { return writeHz; }
+		uint32_t Get_Read_Clock(void) const { return readHz; }
+
+	private:
+		SPISettings writeSettings;
+		SPISettings readSettings;
+		uint32_t writeHz;
+		uint32_t readHz;
+		boolean reading;
+		boolean selected;
+};
+#endif
+
+#if defined(LCDWIKI_HOST) || defined(LCDWIKI_RECORDING)
+
+#define LCDWIKI_TRANSPORT_ASYNC
+
+// The types of event that the recording transport logs
+#define LCD_BUS_CS_ACTIVE   0
+#define LCD_BUS_CS_IDLE     1
+#define LCD_BUS_CD_COMMAND  2
+#define LCD_BUS_CD_DATA     3
+#define LCD_BUS_CMD         4
+#define LCD_BUS_DATA        5
+#define LCD_BUS_READ        6
+
+typedef struct _lcd_bus_event {
+	uint8_t type;
+	uint8_t value;
+} lcd_bus_event;
+
+/*!
+ * @brief A transport that drives no hardware at all, it records every byte
+ *   and every CS/CD edge to memory instead.  This lets the driver run on a
+ *   host (or on a board with nothing attached) to count what each of the
+ *   drawing functions puts on the wire.
+ *
+ *   The counters are always kept, the event log is only kept if a buffer has
+ *   been given with Set_Log().  Once the log buffer is full, the later events
+ *   are counted but not logged.
+ */
+class LCDWIKI_Recording_Transport {
+	public:
+		// there are no pins, they are only taken to match the other transports
+		void Begin(int8_t, int8_t, int8_t, int8_t, int8_t, boolean) {
+			log = 0;
+			logSize = 0;
+			readData = 0;
+			readSize = 0;
+			csState = 1;
+			cdState = 1;
+			asyncLatency = 1;
+			asyncPolls = 0;
+			reading = false;
+			Set_Clock(SPI_WRITE_CLOCK, SPI_READ_CLOCK);
+			Reset();
+		}
+
+		inline void Cs_Active(void) { Drive(csState, 0, LCD_BUS_CS_ACTIVE, csEdges); }
+		inline void Cs_Idle(void) { Drive(csState, 1, LCD_BUS_CS_IDLE, csEdges); }
+		inline void Cd_Command(void) { Drive(cdState, 0, LCD_BUS_CD_COMMAND, cdEdges); }
+		inline void Cd_Data(void) { Drive(cdState, 1, LCD_BUS_CD_DATA, cdEdges); }
+
+		inline void Write8(uint8_t data) {
+			if(asyncPolls) {
+				busyWrites++;
+			}
+
+			if(cdState) {
+				dataBytes++;
+				Log(LCD_BUS_DATA, data);
+			} else {
+				cmdBytes++;
+				Log(LCD_BUS_CMD, data);
+			}
+		}
+
+		inline uint8_t Read8(void) {
+			uint8_t data = 0xFF;
+
+			if(readBytes < readSize) {
+				data = readData[readBytes];
+			}
+			readBytes++;
+			Log(LCD_BUS_READ, data);
+			return data;
+		}
+
+		void Write_Block(const uint8_t *block, size_t n) {
+			while(n--) {
+				Write8(*block++);
+			}
+		}
+
+		void Write_Pattern(const uint8_t *pattern, uint8_t len, uint32_t count) {
+			while(count--) {
+				Write_Block(pattern, len);
+			}
+		}
+
+		void Read_Block(uint8_t *block, size_t n) {
+			while(n--) {
+				*block++ = Read8();
+			}
+		}
+
+		inline void Set_Reading(boolean r) { reading = r; }
+
+		// the clock rates are only kept, so that a test can see what was picked
+		void Set_Clock(uint32_t write_hz, uint32_t read_hz) {
+			writeHz = write_hz;
+			readHz = read_hz;
+		}
+
+		uint32_t Get_Write_Clock(void) const { return writeHz; }
+		uint32_t Get_Read_Clock(void) const { return readHz; }
+		boolean Is_Reading(void) const { return reading; }
+
+		/*!
+		 * @brief The bytes are recorded straight away, then the transport
+		 *   reports that it is busy for the next Set_Async_Latency() calls to
+		 *   Is_Busy(), as if the block were still going out by DMA.
+		 */
+		void Write_Block_Async(const uint8_t *block, size_t n) {
+			Write_Block(block, n);
+			asyncBlocks++;
+			asyncPolls = asyncLatency;
+		}
+
+		inline boolean Is_Busy(void) {
+			if(asyncPolls) {
+				asyncPolls--;
+				return true;
+			}
+			return false;
+		}
+
+		/*!
+		 * @brief Set how many calls to Is_Busy() an async write stays busy for
+		 */
+		void Set_Async_Latency(uint32_t polls) {
+			asyncLatency = polls;
+		}
+
+		/*!
+		 * @brief Zero all of the counters and empty the log
+		 */
+		void Reset(void) {
+			asyncPolls = 0;
+			asyncBlocks = 0;
+			busyWrites = 0;
+			cmdBytes = 0;
+			dataBytes = 0;
+			readBytes = 0;
+			csEdges = 0;
+			cdEdges = 0;
+			pinWrites = 0;
+			logCount = 0;
+		}
+
+		/*!
+		 * @brief Set the buffer that events are logged to
+		 *
+		 * @param buffer The buffer for the events, or NULL to stop logging
+		 * @param size The number of events that the buffer will hold
+		 */
+		void Set_Log(lcd_bus_event *buffer, uint32_t size) {
+			log = buffer;
+			logSize = buffer ? size : 0;
+			logCount = 0;
+		}
+
+		/*!
+		 * @brief Set the bytes that Read8() returns, in order.  Once they run
+		 *   out, Read8() returns 0xFF.  The read position starts again after
+		 *   Reset().
+		 */
+		void Set_Read_Data(const uint8_t *data, uint32_t size) {
+			readData = data;
+			readSize = data ? size : 0;
+		}
+
+		uint32_t Get_Cmd_Bytes(void) const { return cmdBytes; }
+		uint32_t Get_Data_Bytes(void) const { return dataBytes; }
+		uint32_t Get_Read_Bytes(void) const { return readBytes; }
+		uint32_t Get_Cs_Edges(void) const { return csEdges; }
+		uint32_t Get_Cd_Edges(void) const { return cdEdges; }
+		// every write to the CS and CD lines, including the ones that did not change the level
+		uint32_t Get_Pin_Writes(void) const { return pinWrites; }
+		uint32_t Get_Async_Blocks(void) const { return asyncBlocks; }
+		// bytes and pin writes made while an async write was still busy, which is a driver bug
+		uint32_t Get_Busy_Writes(void) const { return busyWrites; }
+		uint32_t Get_Log_Count(void) const { return logCount; }
+		const lcd_bus_event *Get_Log(void) const { return log; }
+
+	private:
+		inline void Log(uint8_t type, uint8_t value) {
+			if(logCount < logSize) {
+				log[logCount].type = type;
+				log[logCount].value = value;
+				logCount++;
+			}
+		}
+
+		inline void Drive(uint8_t &state, uint8_t level, uint8_t type, uint32_t &edges) {
+			pinWrites++;
+			if(asyncPolls) {
+				busyWrites++;
+			}
+
+			if(state != level) {
+				state = level;
+				edges++;
+				Log(type, level);
+			}
+		}
+
+		lcd_bus_event *log;
+		uint32_t logSize;
+		uint32_t logCount;
+
+		const uint8_t *readData;
+		uint32_t readSize;
+
+		uint32_t cmdBytes;
+		uint32_t dataBytes;
+		uint32_t readBytes;
+		uint32_t csEdges;
+		uint32_t cdEdges;
+		uint32_t pinWrites;
+
+		uint32_t asyncLatency;
+		uint32_t asyncPolls;
+		uint32_t asyncBlocks;
+		uint32_t busyWrites;
+
+		uint32_t writeHz;
+		uint32_t readHz;
+		boolean reading;
+
+		uint8_t csState;
+		uint8_t cdState;
+};
+
+typedef LCDWIKI_Recording_Transport LCDWIKI_Transport;
+
+#elif defined(__AVR__)
+
+// One bit of a software SPI write: put the bit on MOSI, then clock it in on
+// the rising edge.  The port values are worked out before the byte starts, so
+// each bit is a skip and two or three stores, with no read-modify-write.
+#define LCD_SOFT_BIT_SHARED(data, bit) { uint8_t v = ((data) & (bit)) ? hi : lo; *spimosiPort = v; *spimosiPort = v | spiclkPinSet; }
+#define LCD_SOFT_BIT(data, bit) { *spimosiPort = ((data) & (bit)) ? hi : lo; *spiclkPort = clkLo; *spiclkPort = clkHi; }
+// One bit of a software SPI read, sampled after the rising edge
+#define LCD_SOFT_READ_BIT(val, bit) { *spiclkPort = clkLo; *spiclkPort = clkHi; if(*spimisoPort & spimisoPinSet) val |= (bit); }
+
+/*!
+ * @brief The AVR transport drives the control lines straight through the port
+ *   registers, and the hardware SPI through SPDR.
+ *
+ *   Software SPI takes a snapshot of the MOSI and CLK ports at the start of
+ *   each byte, so an interrupt that changes another pin on the same port in
+ *   the middle of a byte will have that change undone.
+ */
+class LCDWIKI_AVR_Transport {
+	public:
+		void Begin(int8_t cs, int8_t cd, int8_t miso, int8_t mosi, int8_t clk, boolean hw) {
+			hw_spi = hw;
+			clock.Begin();
+
+			spicsPort = portOutputRegister(digitalPinToPort(cs));
+			spicsPinSet = digitalPinToBitMask(cs);
+			spicsPinUnset = ~spicsPinSet;
+
+			if(cd < 0) {
+				spicdPort = &unusedPort;
+				spicdPinSet = 0;
+				spicdPinUnset = 0xFF;
+			} else {
+				spicdPort = portOutputRegister(digitalPinToPort(cd));
+				spicdPinSet = digitalPinToBitMask(cd);
+				spicdPinUnset = ~spicdPinSet;
+			}
+
+			*spicsPort |= spicsPinSet; // Set all control bits to HIGH (idle)
+			*spicdPort |= spicdPinSet; // Signals are ACTIVE LOW
+
+			pinMode(cs, OUTPUT); // Enable outputs
+			if(cd >= 0) {
+				pinMode(cd, OUTPUT);
+			}
+
+			if(hw) {
+				spimisoPort = &unusedPort;
+				spimisoPinSet = 0;
+				spimosiPort = &unusedPort;
+				spimosiPinSet = 0;
+				spimosiPinUnset = 0xFF;
+				spiclkPort = &unusedPort;
+				spiclkPinSet = 0;
+				spiclkPinUnset = 0xFF;
+
+				sharedPort = false;
+
+				SPI.begin();
+				return;
+			}
+
+			if(miso < 0) {
+				spimisoPort = &unusedPort;
+				spimisoPinSet = 0;
+			} else {
+				// pull up the input, then read it through the input register
+				*portOutputRegister(digitalPinToPort(miso)) |= digitalPinToBitMask(miso);
+				spimisoPort = portInputRegister(digitalPinToPort(miso));
+				spimisoPinSet = digitalPinToBitMask(miso);
+				pinMode(miso, INPUT);
+			}
+
+			spimosiPort = portOutputRegister(digitalPinToPort(mosi));
+			spimosiPinSet = digitalPinToBitMask(mosi);
+			spimosiPinUnset = ~spimosiPinSet;
+
+			spiclkPort = portOutputRegister(digitalPinToPort(clk));
+			spiclkPinSet = digitalPinToBitMask(clk);
+			spiclkPinUnset = ~spiclkPinSet;
+
+			sharedPort = (spimosiPort == spiclkPort);
+
+			*spimosiPort |= spimosiPinSet;
+			*spiclkPort |= spiclkPinSet;
+
+			pinMode(mosi, OUTPUT);
+			pinMode(clk, OUTPUT);
+		}
+
+		inline void Cs_Active(void) {
+			if(hw_spi) {
+				clock.Select();
+			}
+			*spicsPort &= spicsPinUnset;
+		}
+
+		inline void Cs_Idle(void) {
+			*spicsPort |= spicsPinSet;
+			if(hw_spi) {
+				clock.Release();
+			}
+		}
+
+		inline void Cd_Command(void) { *spicdPort &= spicdPinUnset; }
+		inline void Cd_Data(void) { *spicdPort |= spicdPinSet; }
+
+		inline void Write8(uint8_t data) {
+			if(hw_spi) {
+				SPI.transfer(data);
+			} else {
+				Soft_Write8(data);
+			}
+		}
+
+		inline uint8_t Read8(void) {
+			if(hw_spi) {
+				return SPI.transfer(0xFF);
+			}
+			return Soft_Read8();
+		}
+
+		void Write_Block(const uint8_t *block, size_t n) {
+			if(n == 0) {
+				return;
+			}
+
+			if(hw_spi) {
+				// load the next byte while the previous one is still on the wire
+				SPDR = *block++;
+				while(--n) {
+					uint8_t next = *block++;
+					while(!(SPSR & _BV(SPIF)));
+					SPDR = next;
+				}
+				while(!(SPSR & _BV(SPIF)));
+			} else {
+				while(n--) {
+					Soft_Write8(*block++);
+				}
+			}
+		}
+
+		/*!
+		 * @brief Write the same 1 to 4 bytes count times, for filling with one
+		 *   colour.  With software SPI the port value for every bit of the
+		 *   pattern is worked out once, and if MOSI never changes across the
+		 *   pattern (black, white, and the like) only the clock is toggled.
+		 */
+		void Write_Pattern(const uint8_t *pattern, uint8_t len, uint32_t count) {
+			if((count == 0) || (len == 0) || (len > 4)) {
+				return;
+			}
+
+			if(hw_spi) {
+				uint8_t i = 0;
+
+				SPDR = pattern[0];
+				count = count * len - 1;
+				while(count--) {
+					if(++i == len) {
+						i = 0;
+					}
+					uint8_t next = pattern[i];
+					while(!(SPSR & _BV(SPIF)));
+					SPDR = next;
+				}
+				while(!(SPSR & _BV(SPIF)));
+				return;
+			}
+
+			uint8_t bits[32];
+			uint8_t nbits = len * 8;
+			uint8_t ones = 0;
+			uint8_t lo = *spimosiPort & spimosiPinUnset;
+			uint8_t hi;
+			uint8_t clkLo;
+			uint8_t clkHi;
+
+			if(sharedPort) {
+				// CLK is low in every value, it is raised by a second store
+				lo &= spiclkPinUnset;
+			}
+			hi = lo | spimosiPinSet;
+
+			for(uint8_t i = 0; i < nbits; i++) {
+				if(pattern[i >> 3] & (0x80 >> (i & 7))) {
+					bits[i] = hi;
+					ones++;
+				} else {
+					bits[i] = lo;
+				}
+			}
+
+			if(sharedPort) {
+				uint8_t clk = spiclkPinSet;
+
+				while(count--) {
+					for(uint8_t i = 0; i < nbits; i++) {
+						*spimosiPort = bits[i];
+						*spimosiPort = bits[i] | clk;
+					}
+				}
+				return;
+			}
+
+			clkLo = *spiclkPort & spiclkPinUnset;
+			clkHi = clkLo | spiclkPinSet;
+
+			if((ones == 0) || (ones == nbits)) {
+				// MOSI stays where it is for the whole fill
+				*spimosiPort = bits[0];
+				while(count--) {
+					for(uint8_t i = 0; i < nbits; i++) {
+						*spiclkPort = clkLo;
+						*spiclkPort = clkHi;
+					}
+				}
+				return;
+			}
+
+			while(count--) {
+				for(uint8_t i = 0; i < nbits; i++) {
+					*spimosiPort = bits[i];
+					*spiclkPort = clkLo;
+					*spiclkPort = clkHi;
+				}
+			}
+		}
+
+		void Read_Block(uint8_t *block, size_t n) {
+			if(hw_spi) {
+				while(n--) {
+					SPDR = 0xFF;
+					while(!(SPSR & _BV(SPIF)));
+					*block++ = SPDR;
+				}
+			} else {
+				while(n--) {
+					*block++ = Soft_Read8();
+				}
+			}
+		}
+
+		// there is no DMA, so the async write is done before it returns
+		inline void Write_Block_Async(const uint8_t *block, size_t n) { Write_Block(block, n); }
+		inline boolean Is_Busy(void) { return false; }
+
+		// the clock rates only apply to hardware SPI, software SPI runs flat out
+		inline void Set_Reading(boolean r) {
+			if(hw_spi) {
+				clock.Set_Reading(r);
+			}
+		}
+
+		void Set_Clock(uint32_t write_hz, uint32_t read_hz) { clock.Set(write_hz, read_hz); }
+		uint32_t Get_Write_Clock(void) const { return clock.Get_Write_Clock(); }
+		uint32_t Get_Read_Clock(void) const { return clock.Get_Read_Clock(); }
+
+	private:
+		inline void Soft_Write8(uint8_t data) {
+			uint8_t lo = *spimosiPort & spimosiPinUnset;
+			uint8_t hi;
+
+			if(sharedPort) {
+				lo &= spiclkPinUnset;
+				hi = lo | spimosiPinSet;
+				LCD_SOFT_BIT_SHARED(data, 0x80);
+				LCD_SOFT_BIT_SHARED(data, 0x40);
+				LCD_SOFT_BIT_SHARED(data, 0x20);
+				LCD_SOFT_BIT_SHARED(data, 0x10);
+				LCD_SOFT_BIT_SHARED(data, 0x08);
+				LCD_SOFT_BIT_SHARED(data, 0x04);
+				LCD_SOFT_BIT_SHARED(data, 0x02);
+				LCD_SOFT_BIT_SHARED(data, 0x01);
+			} else {
+				uint8_t clkLo = *spiclkPort & spiclkPinUnset;
+				uint8_t clkHi = clkLo | spiclkPinSet;
+
+				hi = lo | spimosiPinSet;
+				LCD_SOFT_BIT(data, 0x80);
+				LCD_SOFT_BIT(data, 0x40);
+				LCD_SOFT_BIT(data, 0x20);
+				LCD_SOFT_BIT(data, 0x10);
+				LCD_SOFT_BIT(data, 0x08);
+				LCD_SOFT_BIT(data, 0x04);
+				LCD_SOFT_BIT(data, 0x02);
+				LCD_SOFT_BIT(data, 0x01);
+			}
+		}
+
+		inline uint8_t Soft_Read8(void) {
+			uint8_t clkLo = *spiclkPort & spiclkPinUnset;
+			uint8_t clkHi = clkLo | spiclkPinSet;
+			uint8_t val = 0;
+
+			LCD_SOFT_READ_BIT(val, 0x80);
+			LCD_SOFT_READ_BIT(val, 0x40);
+			LCD_SOFT_READ_BIT(val, 0x20);
+			LCD_SOFT_READ_BIT(val, 0x10);
+			LCD_SOFT_READ_BIT(val, 0x08);
+			LCD_SOFT_READ_BIT(val, 0x04);
+			LCD_SOFT_READ_BIT(val, 0x02);
+			LCD_SOFT_READ_BIT(val, 0x01);
+			return val;
+		}
+
+	private:
+		boolean hw_spi;
+		LCDWIKI_Spi_Clock clock;
+		// MOSI and CLK are on the same port
+		boolean sharedPort;
+
+		volatile uint8_t *spicsPort;
+		volatile uint8_t *spicdPort;
+		volatile uint8_t *spimisoPort;
+		volatile uint8_t *spimosiPort;
+		volatile uint8_t *spiclkPort;
+
+		// stands in for the port of a pin that is not connected
+		volatile uint8_t unusedPort;
+
+		uint8_t spicsPinSet;
+		uint8_t spicdPinSet;
+		uint8_t spimisoPinSet;
+		uint8_t spimosiPinSet;
+		uint8_t spiclkPinSet;
+		uint8_t spicsPinUnset;
+		uint8_t spicdPinUnset;
+		uint8_t spimosiPinUnset;
+		uint8_t spiclkPinUnset;
+};
+
+typedef LCDWIKI_AVR_Transport LCDWIKI_Transport;
+
+#undef LCD_SOFT_BIT_SHARED
+#undef LCD_SOFT_BIT
+#undef LCD_SOFT_READ_BIT
+
+#else
+
+/*!
+ * @brief Write_Pattern() for the transports that have no faster way to do it,
+ *   the pattern is repeated to fill a block which is then sent with the 
+ *   transport's own Write_Block() as many times as is needed.
+ */
+template<class TRANSPORT>
+void lcd_write_pattern(TRANSPORT &bus, const uint8_t *pattern, uint8_t len, uint32_t count) {
+	uint8_t buf[SPI_BLOCK_SIZE];
+	uint8_t reps;
+
+	if((count == 0) || (len == 0) || (len > SPI_BLOCK_SIZE)) {
+		return;
+	}
+
+	reps = SPI_BLOCK_SIZE / len;
+	if(reps > count) {
+		reps = count;
+	}
+
+	for(uint8_t i = 0; i < reps; i++) {
+		memcpy(buf + i * len, pattern, len);
+	}
+
+	while(count >= reps) {
+		bus.Write_Block(buf, reps * len);
+		count -= reps;
+	}
+	bus.Write_Block(buf, count * len);
+}
+
+/*!
+ * @brief The portable transport, the control lines go through digitalWrite()
+ *   and the data through the Arduino SPI library (or bit banged through
+ *   digitalWrite() for software SPI).
+ */
+class LCDWIKI_Arduino_Transport {
+	public:
+		void Begin(int8_t cs, int8_t cd, int8_t miso, int8_t mosi, int8_t clk, boolean hw) {
+			hw_spi = hw;
+			clock.Begin();
+			_cs = cs;
+			_cd = cd;
+			_miso = miso;
+			_mosi = mosi;
+			_clk = clk;
+
+			digitalWrite(_cs, HIGH); // Set all control bits to HIGH (idle)
+			pinMode(_cs, OUTPUT);
+			if(_cd >= 0) {
+				digitalWrite(_cd, HIGH);
+				pinMode(_cd, OUTPUT);
+			}
+
+			if(hw) {
+				SPI.begin();
+				return;
+			}
+
+			if(_miso >= 0) {
+				pinMode(_miso, INPUT);
+			}
+			digitalWrite(_mosi, HIGH);
+			pinMode(_mosi, OUTPUT);
+			digitalWrite(_clk, HIGH);
+			pinMode(_clk, OUTPUT);
+		}
+
+		inline void Cs_Active(void) {
+			if(hw_spi) {
+				clock.Select();
+			}
+			digitalWrite(_cs, LOW);
+		}
+
+		inline void Cs_Idle(void) {
+			digitalWrite(_cs, HIGH);
+			if(hw_spi) {
+				clock.Release();
+			}
+		}
+
+		inline void Cd_Command(void) { if(_cd >= 0) digitalWrite(_cd, LOW); }
+		inline void Cd_Data(void) { if(_cd >= 0) digitalWrite(_cd, HIGH); }
+
+		inline void Write8(uint8_t data) {
+			if(hw_spi) {
+				SPI.transfer(data);
+			} else {
+				uint8_t val = 0x80;
+				while(val) {
+					digitalWrite(_mosi, (data & val) ? HIGH : LOW);
+					digitalWrite(_clk, LOW);
+					digitalWrite(_clk, HIGH);
+					val >>= 1;
+				}
+			}
+		}
+
+		inline uint8_t Read8(void) {
+			if(hw_spi) {
+				return SPI.transfer(0xFF);
+			}
+
+			uint8_t val = 0;
+			for(uint8_t i = 0; i < 8; i++) {
+				digitalWrite(_clk, LOW);
+				digitalWrite(_clk, HIGH);
+				val <<= 1;
+				if((_miso >= 0) && digitalRead(_miso)) {
+					val |= 0x01;
+				}
+			}
+			return val;
+		}
+
+		void Write_Block(const uint8_t *block, size_t n) {
+			if(hw_spi) {
+				// the buffered transfer overwrites the buffer with the read data
+				uint8_t buf[SPI_BLOCK_SIZE];
+				while(n) {
+					size_t len = (n > SPI_BLOCK_SIZE) ? SPI_BLOCK_SIZE : n;
+					memcpy(buf, block, len);
+					SPI.transfer(buf, len);
+					block += len;
+					n -= len;
+				}
+			} else {
+				while(n--) {
+					Write8(*block++);
+				}
+			}
+		}
+
+		void Write_Pattern(const uint8_t *pattern, uint8_t len, uint32_t count) {
+			lcd_write_pattern(*this, pattern, len, count);
+		}
+
+		void Read_Block(uint8_t *block, size_t n) {
+			if(hw_spi) {
+				// the buffered transfer reads into the buffer that it sends, 
+				// some cores only take a 16 bit count
+				while(n) {
+					size_t len = (n > 0x8000) ? 0x8000 : n;
+					memset(block, 0xFF, len);
+					SPI.transfer(block, len);
+					block += len;
+					n -= len;
+				}
+			} else {
+				while(n--) {
+					*block++ = Read8();
+				}
+			}
+		}
+
+		// there is no DMA, so the async write is done before it returns
+		inline void Write_Block_Async(const uint8_t *block, size_t n) { Write_Block(block, n); }
+		inline boolean Is_Busy(void) { return false; }
+
+		// the clock rates only apply to hardware SPI, software SPI runs flat out
+		inline void Set_Reading(boolean r) {
+			if(hw_spi) {
+				clock.Set_Reading(r);
+			}
+		}
+
+		void Set_Clock(uint32_t write_hz, uint32_t read_hz) { clock.Set(write_hz, read_hz); }
+		uint32_t Get_Write_Clock(void) const { return clock.Get_Write_Clock(); }
+		uint32_t Get_Read_Clock(void) const { return clock.Get_Read_Clock(); }
+
+	protected:
+		boolean hw_spi;
+		LCDWIKI_Spi_Clock clock;
+
+		int8_t _cs;
+		int8_t _cd;
+		int8_t _miso;
+		int8_t _mosi;
+		int8_t _clk;
+};
+
+#if defined(ARDUINO_ARCH_ESP8266)
+
+/*!
+ * @brief The ESP8266 only has hardware SPI (see USE_HWSPI_ONLY).  CS and CD 
+ *   are driven straight through the GPOS/GPOC set and clear registers, and 
+ *   blocks and fills go through the 64 byte SPI FIFO with writeBytes() and
+ *   writePattern().  GPIO16 is not on those registers, so a CS or CD on pin 
+ *   16 still goes through digitalWrite().
+ */
+class LCDWIKI_ESP8266_Transport: public LCDWIKI_Arduino_Transport {
+	public:
+		void Begin(int8_t cs, int8_t cd, int8_t miso, int8_t mosi, int8_t clk, boolean hw) {
+			LCDWIKI_Arduino_Transport::Begin(cs, cd, miso, mosi, clk, hw);
+
+			csMask = ((cs >= 0) && (cs < 16)) ? (1UL << cs) : 0;
+			cdMask = ((cd >= 0) && (cd < 16)) ? (1UL << cd) : 0;
+		}
+
+		inline void Cs_Active(void) {
+			if(hw_spi) {
+				clock.Select();
+			}
+
+			if(csMask) {
+				GPOC = csMask;
+			} else {
+				digitalWrite(_cs, LOW);
+			}
+		}
+
+		inline void Cs_Idle(void) {
+			if(csMask) {
+				GPOS = csMask;
+			} else {
+				digitalWrite(_cs, HIGH);
+			}
+
+			if(hw_spi) {
+				clock.Release();
+			}
+		}
+
+		inline void Cd_Command(void) {
+			if(cdMask) {
+				GPOC = cdMask;
+			} else if(_cd >= 0) {
+				digitalWrite(_cd, LOW);
+			}
+		}
+
+		inline void Cd_Data(void) {
+			if(cdMask) {
+				GPOS = cdMask;
+			} else if(_cd >= 0) {
+				digitalWrite(_cd, HIGH);
+			}
+		}
+
+		inline void Write8(uint8_t data) {
+			if(hw_spi) {
+				SPI.write(data);
+			} else {
+				LCDWIKI_Arduino_Transport::Write8(data);
+			}
+		}
+
+		void Write_Block(const uint8_t *block, size_t n) {
+			if(hw_spi) {
+				// the FIFO is filled 64 bytes at a time, and the block is left alone
+				SPI.writeBytes((uint8_t *)block, n);
+			} else {
+				LCDWIKI_Arduino_Transport::Write_Block(block, n);
+			}
+		}
+
+		void Write_Pattern(const uint8_t *pattern, uint8_t len, uint32_t count) {
+			if(hw_spi) {
+				if(count && len) {
+					SPI.writePattern((uint8_t *)pattern, len, count);
+				}
+			} else {
+				LCDWIKI_Arduino_Transport::Write_Pattern(pattern, len, count);
+			}
+		}
+
+		inline void Write_Block_Async(const uint8_t *block, size_t n) { Write_Block(block, n); }
+
+	private:
+		uint32_t csMask;
+		uint32_t cdMask;
+};
+
+typedef LCDWIKI_ESP8266_Transport LCDWIKI_Transport;
+
+#elif defined(__SAM3X8E__)
+
+#define LCDWIKI_TRANSPORT_ASYNC
+
+// the DMA channel, and the DMAC hardware handshaking interface of the SPI0 transmitter
+#define LCD_DMAC_TX_CH  0
+#define LCD_SPI_TX_IDX  1
+
+// NPCS3 (pin 78), the chip select that SPI.transfer(data) clocks with by default
+#define LCD_SPI_PCS     0x07
+
+/*!
+ * @brief The Due transport, the same as the portable transport except that 
+ *   hardware SPI block writes go out through the DMA controller, so that 
+ *   Write_Block_Async() returns as soon as the transfer has started.
+ *
+ *   The SPI library runs SPI0 with variable peripheral select, where every 
+ *   write to TDR carries the chip select bits.  Byte wide DMA cannot set 
+ *   those, so fixed peripheral select is switched on for the length of each 
+ *   DMA transfer.
+ */
+class LCDWIKI_SAM3X_Transport: public LCDWIKI_Arduino_Transport {
+	public:
+		void Begin(int8_t cs, int8_t cd, int8_t miso, int8_t mosi, int8_t clk, boolean hw) {
+			LCDWIKI_Arduino_Transport::Begin(cs, cd, miso, mosi, clk, hw);
+
+			dmaActive = false;
+			if(hw) {
+				pmc_enable_periph_clk(ID_DMAC);
+				DMAC->DMAC_EN = 0;
+				DMAC->DMAC_GCFG = DMAC_GCFG_ARB_CFG_FIXED;
+				DMAC->DMAC_EN = DMAC_EN_ENABLE;
+			}
+		}
+
+		void Write_Block(const uint8_t *block, size_t n) {
+			Write_Block_Async(block, n);
+			while(Is_Busy());
+		}
+
+		void Write_Pattern(const uint8_t *pattern, uint8_t len, uint32_t count) {
+			lcd_write_pattern(*this, pattern, len, count);
+		}
+
+		void Write_Block_Async(const uint8_t *block, size_t n) {
+			if(!hw_spi) {
+				LCDWIKI_Arduino_Transport::Write_Block(block, n);
+				return;
+			}
+
+			while(Is_Busy());
+
+			// the block transfer size is 16 bits wide
+			while(n > 0xFFFF) {
+				Start_Dma(block, 0xFFFF);
+				while(Is_Busy());
+				block += 0xFFFF;
+				n -= 0xFFFF;
+			}
+
+			if(n) {
+				Start_Dma(block, n);
+			}
+		}
+
+		boolean Is_Busy(void) {
+			if(!dmaActive) {
+				return false;
+			}
+
+			// wait for the DMA channel to finish, then for the last byte to leave the shift register
+			if(DMAC->DMAC_CHSR & (DMAC_CHSR_ENA0 << LCD_DMAC_TX_CH)) {
+				return true;
+			}
+			if(!(SPI0->SPI_SR & SPI_SR_TXEMPTY)) {
+				return true;
+			}
+
+			// throw away the byte that was clocked in, so that the next read is clean
+			(void)SPI0->SPI_RDR;
+			SPI0->SPI_MR = savedMR;
+			dmaActive = false;
+			return false;
+		}
+
+	private:
+		void Start_Dma(const uint8_t *block, uint16_t n) {
+			savedMR = SPI0->SPI_MR;
+			SPI0->SPI_MR = (savedMR & ~(SPI_MR_PS | SPI_MR_PCS_Msk)) | SPI_MR_PCS(LCD_SPI_PCS);
+
+			DMAC->DMAC_CHDR = DMAC_CHDR_DIS0 << LCD_DMAC_TX_CH;
+			DMAC->DMAC_CH_NUM[LCD_DMAC_TX_CH].DMAC_SADDR = (uint32_t)block;
+			DMAC->DMAC_CH_NUM[LCD_DMAC_TX_CH].DMAC_DADDR = (uint32_t)&SPI0->SPI_TDR;
+			DMAC->DMAC_CH_NUM[LCD_DMAC_TX_CH].DMAC_DSCR = 0;
+			DMAC->DMAC_CH_NUM[LCD_DMAC_TX_CH].DMAC_CTRLA = n | DMAC_CTRLA_SRC_WIDTH_BYTE | DMAC_CTRLA_DST_WIDTH_BYTE;
+			DMAC->DMAC_CH_NUM[LCD_DMAC_TX_CH].DMAC_CTRLB = DMAC_CTRLB_SRC_DSCR | DMAC_CTRLB_DST_DSCR | 
+					DMAC_CTRLB_FC_MEM2PER_DMA_FC | DMAC_CTRLB_SRC_INCR_INCREMENTING | DMAC_CTRLB_DST_INCR_FIXED;
+			DMAC->DMAC_CH_NUM[LCD_DMAC_TX_CH].DMAC_CFG = DMAC_CFG_DST_PER(LCD_SPI_TX_IDX) | DMAC_CFG_DST_H2SEL | 
+					DMAC_CFG_SOD | DMAC_CFG_FIFOCFG_ALAP_CFG;
+			DMAC->DMAC_CHER = DMAC_CHER_ENA0 << LCD_DMAC_TX_CH;
+			dmaActive = true;
+		}
+
+		boolean dmaActive;
+		uint32_t savedMR;
+};
+
+typedef LCDWIKI_SAM3X_Transport LCDWIKI_Transport;
+
+#else
+
+typedef LCDWIKI_Arduino_Transport LCDWIKI_Transport;
+
+#endif
+
+#endif
+
+#endif // _lcd_spi_transport_
@@ -2,37 +2,24 @@
 #define _mcu_spi_magic_
 
 //#define write8(d) {Spi_Write(d);}
-#define write8(d) Spi_Write(d)
-#define read8(dst) { dst=Spi_Read();}
-#define setWriteDir() 
-#define setReadDir()  
+#define write8(d) bus.Write8(d)
+#define read8(dst) { dst=bus.Read8();}
+// reads run at the slower read clock, see Set_Spi_Clock()
+#define setWriteDir() bus.Set_Reading(false)
+#define setReadDir()  bus.Set_Reading(true)
 
 #define RD_ACTIVE   0
 #define RD_IDLE     0
 #define WR_ACTIVE   0
 #define WR_IDLE     0
 
-#if defined(__AVR__)
-	#define CD_COMMAND  *spicdPort &= spicdPinUnset
-	#define CD_DATA     *spicdPort |= spicdPinSet
-	#define CS_ACTIVE   *spicsPort &= spicsPinUnset
-	#define CS_IDLE     *spicsPort |= spicsPinSet
-	#define MISO_STATE(x) { x = *spimisoPort&spimisoPinSet;}
-	#define MOSI_LOW *spimosiPort &= spimosiPinUnset
-	#define MOSI_HIGH   *spimosiPort |= spimosiPinSet
-	#define CLK_LOW  *spiclkPort &= spiclkPinUnset
-	#define CLK_HIGH    *spiclkPort |= spiclkPinSet
-#elif defined(ARDUINO_ARCH_ESP8266)
-	#define CD_COMMAND  (digitalWrite(_cd,LOW))
-	#define CD_DATA     (digitalWrite(_cd,HIGH)) 
-	#define CS_ACTIVE   (digitalWrite(_cs,LOW)) 
-	#define CS_IDLE     (digitalWrite(_cs,HIGH)) 
-	#define MISO_STATE(x) { x = digitalRead(_miso);}
-	#define MOSI_LOW    (digitalWrite(_mosi,LOW)) 
-	#define MOSI_HIGH   (digitalWrite(_mosi,HIGH)) 
-	#define CLK_LOW     (digitalWrite(_clk,LOW)) 
-	#define CLK_HIGH    (digitalWrite(_clk,HIGH)) 
-#endif
+// the bus lines are driven by the transport, see lcd_spi_transport.h, only 
+// when their level changes.  CS_IDLE does nothing inside Begin_Batch(), and 
+// an async push still on the wire is finished before the chip is selected.
+#define CD_COMMAND  Bus_Cd_Command()
+#define CD_DATA     Bus_Cd_Data()
+#define CS_ACTIVE   Bus_Cs_Active()
+#define CS_IDLE     Bus_Cs_Idle()
 
 #define WR_STROBE { }
 #define RD_STROBE { }  
@@ -50,7 +37,6 @@
 
 #define writeCmd16(x)  CD_COMMAND; write16(x)
 #define writeData16(x)  CD_DATA; write16(x)
-#define writeData18(x)  CD_DATA; write8((x>>8)&0xF8);write8((x>>3)&0xFC);write8(x<<3)
 
 
 //#define writeCmdData8(a, d) { CD_COMMAND; write8(a); CD_DATA; write8(d); }
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+# Make the tables of an LCDWIKI_Font from a BDF font and a list of characters
+# MIT license
+#
+# usage: make_font.py [--bits 2|4 --scale n] font.bdf chars.txt name > name.h
+#
+# chars.txt is UTF-8 text holding each character that the font should have
+# (white space is ignored, repeats are dropped), such as the strings that a
+# sketch shows.  The output defines name_codes and name_bitmaps in PROGMEM
+# and the LCDWIKI_Font name, for LCDWIKI_SPI::Draw_Font_String().  Every 
+# glyph is drawn into a cell the size of the BDF font bounding box.
+#
+# With --bits 2 or 4 the font is anti-aliased: each n x n block of the BDF
+# glyph (n is --scale, 4 by default) becomes one pixel of its coverage from
+# 0 to 3 or 15, so the BDF font should be n times the size of the one that
+# is wanted.
+
+import os
+import sys
+
+
+def read_bdf(path):
+	"""Return the cell width, height, left edge and baseline of a BDF font,
+	and a dict of character to (bbx, rows) where each row is an int of its
+	bits, left hand pixel in the top bit of the first byte."""
+	glyphs = {}
+	width = height = left = descent = 0
+	code = None
+	bbx = None
+	rows = None
+
+	with open(path, encoding='latin-1') as f:
+		for line in f:
+			words = line.split()
+			if not words:
+				continue
+			if words[0] == 'FONTBOUNDINGBOX':
+				width, height = int(words[1]), int(words[2])
+				left = int(words[3])
+				descent = -int(words[4])
+			elif words[0] == 'ENCODING':
+				code = int(words[1])
+			elif words[0] == 'BBX':
+				bbx = [int(w) for w in words[1:5]]
+			elif words[0] == 'BITMAP':
+				rows = []
+			elif words[0] == 'ENDCHAR':
+				if code is not None and code >= 0:
+					glyphs[code] = (bbx, rows)
+				code = None
+				rows = None
+			elif rows is not None:
+				rows.append(words[0])
+
+	return width, height, left, descent, glyphs
+
+
+def render(width, height, left, descent, bbx, rows):
+	"""Draw one BDF glyph into the cell, returning its rows of 0 and 1."""
+	cell = [[0] * width for _ in range(height)]
+	w, h, xoff, yoff = bbx
+	top = height - descent - yoff - h
+
+	for j, hexrow in enumerate(rows):
+		bits = int(hexrow, 16)
+		nbits = len(hexrow) * 4
+		for i in range(w):
+			if bits & (1 << (nbits - 1 - i)):
+				x = xoff - left + i
+				y = top + j
+				if 0 <= x < width and 0 <= y < height:
+					cell[y][x] = 1
+	return cell
+
+
+def shrink(cell, scale, top):
+	"""Average each scale x scale block of a cell into a level from 0 to top."""
+	height = (len(cell) + scale - 1) // scale
+	width = (len(cell[0]) + scale - 1) // scale
+	out = [[0] * width for _ in range(height)]
+
+	for y in range(len(cell)):
+		for x in range(len(cell[0])):
+			out[y // scale][x // scale] += cell[y][x]
+	for row in out:
+		for x in range(width):
+			row[x] = (row[x] * top + scale * scale // 2) // (scale * scale)
+	return out
+
+
+def pack(cell, bits):
+	"""Pack the rows of a cell into bytes, bits per pixel, left hand pixel in
+	the top bits of the first byte."""
+	out = []
+	for row in cell:
+		byte = used = 0
+		for level in row:
+			byte = (byte << bits) | level
+			used += bits
+			if used == 8:
+				out.append(byte)
+				byte = used = 0
+		if used:
+			out.append(byte << (8 - used))
+	return out
+
+
+def main(argv):
+	bits, scale = 1, 4
+	while len(argv) > 1 and argv[1] in ('--bits', '--scale') and len(argv) > 2:
+		if argv[1] == '--bits':
+			bits = int(argv[2])
+		else:
+			scale = int(argv[2])
+		del argv[1:3]
+
+	if len(argv) != 4 or bits not in (1, 2, 4) or scale < 1:
+		sys.stderr.write('usage: make_font.py [--bits 2|4 --scale n] font.bdf chars.txt name > name.h\n')
+		return 1
+
+	bdf, chars_path, name = argv[1], argv[2], argv[3]
+	width, height, left, descent, glyphs = read_bdf(bdf)
+	if bits == 1:
+		scale = 1
+	cell_width = (width + scale - 1) // scale
+	cell_height = (height + scale - 1) // scale
+
+	with open(chars_path, encoding='utf-8') as f:
+		wanted = sorted(set(ord(c) for c in f.read() if not c.isspace()))
+
+	codes = []
+	for c in wanted:
+		if c > 0xFFFF:
+			sys.stderr.write('skipping U+%X, outside of 16 bits\n' % c)
+		elif c not in glyphs:
+			sys.stderr.write('skipping U+%04X, not in %s\n' % (c, bdf))
+		else:
+			codes.append(c)
+
+	out = sys.stdout
+	guard = '_%s_H_' % name.upper()
+	out.write('// %s: %d characters of %dx%d, %d bit, from %s, made by tools/make_font.py\n\n' %
+			(name, len(codes), cell_width, cell_height, bits, os.path.basename(bdf)))
+	out.write('#ifndef %s\n#define %s\n\n#include "LCDWIKI_Font.h"\n\n' % (guard, guard))
+
+	out.write('const uint16_t %s_codes[] PROGMEM = {\n' % name)
+	for i in range(0, len(codes), 8):
+		out.write('\t' + ' '.join('0x%04X,' % c for c in codes[i:i + 8]) + '\n')
+	out.write('};\n\n')
+
+	out.write('const uint8_t %s_bitmaps[] PROGMEM = {\n' % name)
+	for c in codes:
+		cell = render(width, height, left, descent, *glyphs[c])
+		if bits > 1:
+			cell = shrink(cell, scale, (1 << bits) - 1)
+		data = pack(cell, bits)
+		# only the code point for a backslash, which would carry the comment
+		# on to the next line, or anything that does not print
+		if chr(c).isprintable() and chr(c) != '\\':
+			out.write('\t// U+%04X %s\n' % (c, chr(c)))
+		else:
+			out.write('\t// U+%04X\n' % c)
+		for i in range(0, len(data), 16):
+			out.write('\t' + ' '.join('0x%02X,' % b for b in data[i:i + 16]) + '\n')
+	out.write('};\n\n')
+
+	if bits == 1:
+		out.write('LCDWIKI_Font %s(%d, %d, %d, %s_codes, %s_bitmaps);\n\n' %
+				(name, cell_width, cell_height, len(codes), name, name))
+	else:
+		out.write('LCDWIKI_Font %s(%d, %d, %d, %s_codes, %s_bitmaps, %d);\n\n' %
+				(name, cell_width, cell_height, len(codes), name, name, bits))
+	out.write('#endif\n')
+	return 0
+
+
+if __name__ == '__main__':
+	sys.exit(main(sys.argv))